@@ -0,0 +1,120 @@
+#ifndef SHARD_RUNNER_H
+#define SHARD_RUNNER_H
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Splits a backtest into date/symbol shards, runs each shard in its own worker
+// process and deterministically merges the partial results.
+//
+// A worker only sees its own shard and always starts flat. Positions that are
+// still open at the end of a shard are reported as net quantity changes with
+// their last mark, and the merge step carries them into the following shards
+// of the same symbol and books the mark-to-market P&L there.
+//
+// Carried positions are only marked at shard ends: their P&L over a shard is
+// booked as one lump at that shard's last_timestamp, from the previous mark to
+// the shard's last_mark for the contract (a contract missing from a shard's
+// activity is not marked there). The merged P&L curve and max_drawdown
+// therefore do not see moves of carried positions inside a shard; use shorter
+// shards when a finer mark schedule matters.
+//
+// Shard results are plain files, so shards can also be run on other hosts that
+// share storage by calling run_shard there and merging the files afterwards.
+namespace backtest {
+
+    // One unit of work: a symbol over a closed timestamp range.
+    struct ShardSpec {
+        std::uint32_t index{};           // Position of the shard in the full shard list
+        std::string symbol;              // Underlying symbol
+        std::int64_t first_timestamp{};  // First timestamp covered (inclusive)
+        std::int64_t last_timestamp{};   // Last timestamp covered (inclusive)
+    };
+
+    // P&L booked at a timestamp (an increment, not a running total).
+    struct PnlPoint {
+        std::int64_t timestamp{};
+        double pnl{};
+    };
+
+    // Per-contract activity within a shard.
+    // quantity_change * price must be in P&L currency (i.e., include the contract multiplier).
+    struct ContractActivity {
+        std::uint64_t contract_id{};  // Caller-defined stable identifier of the contract
+        double quantity_change{};     // Net quantity traded in the shard
+        double last_mark{};           // Last price observed in the shard
+    };
+
+    // Partial result produced by one worker. The P&L must include marking the
+    // shard's own open positions to their last_mark at the end of the shard.
+    struct ShardResult {
+        ShardSpec spec;
+        std::vector<PnlPoint> pnl;                  // Flat-start P&L, time ordered
+        std::vector<ContractActivity> contracts;    // Every contract traded or marked in the shard
+        std::uint64_t trade_count{0};
+        std::uint64_t rows_processed{0};
+    };
+
+    // Open position after merging all shards of a symbol.
+    struct MergedPosition {
+        std::string symbol;
+        std::uint64_t contract_id{};
+        double quantity{};
+        double last_mark{};
+    };
+
+    // Combined result of all shards.
+    struct MergedResult {
+        std::vector<PnlPoint> pnl;               // P&L per timestamp across all symbols, time ordered
+        std::vector<MergedPosition> positions;   // Positions still open at the end of the backtest
+        double total_pnl{0.0};
+        double max_drawdown{0.0};                // Largest peak-to-trough fall of cumulative P&L
+        std::uint64_t trade_count{0};
+        std::uint64_t rows_processed{0};
+        std::size_t shard_count{0};
+    };
+
+    // Runs the backtest for one shard. Fills `result` (spec is set by the caller)
+    // and returns false on failure.
+    using ShardWorker = std::function<bool(const ShardSpec& spec, ShardResult& result)>;
+
+    // Splits [first_timestamp, last_timestamp] into consecutive ranges of at most
+    // shard_length for every symbol. Shards are indexed symbol by symbol, in time order.
+    std::vector<ShardSpec> make_shards(const std::vector<std::string>& symbols,
+                                       std::int64_t first_timestamp, std::int64_t last_timestamp,
+                                       std::int64_t shard_length);
+
+    // Path of the partial result file for a shard inside `directory`.
+    std::string shard_result_path(const std::string& directory, const ShardSpec& spec);
+
+    // Writes/reads the compact binary partial result format.
+    // The file is written under a temporary name and renamed, so readers never see a partial file.
+    bool write_shard_result(const std::string& filepath, const ShardResult& result);
+    std::optional<ShardResult> read_shard_result(const std::string& filepath);
+
+    // Runs `worker` for one shard in the current process and writes its result file.
+    // This is the entry point for workers launched on other hosts.
+    bool run_shard(const ShardWorker& worker, const ShardSpec& spec, const std::string& output_path);
+
+    // Runs every shard in a separate forked process, at most max_workers at a time
+    // (0 means one per hardware thread). Result files are written to output_directory.
+    // Only the forked workers are waited for, so other children of the caller are left alone.
+    // Returns false if any worker failed.
+    bool run_local_shards(const std::vector<ShardSpec>& shards, const ShardWorker& worker,
+                          const std::string& output_directory, unsigned max_workers = 0);
+
+    // Merges partial results. The output does not depend on the order of `results`.
+    // Returns std::nullopt if two results claim the same shard index.
+    std::optional<MergedResult> merge_shard_results(std::vector<ShardResult> results);
+
+    // Reads every shard's result file from `directory` and merges them.
+    // Returns std::nullopt if any file is missing or invalid.
+    std::optional<MergedResult> merge_shard_files(const std::vector<ShardSpec>& shards,
+                                                  const std::string& directory);
+
+} // namespace backtest
+
+#endif // SHARD_RUNNER_H
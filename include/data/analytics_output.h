@@ -0,0 +1,185 @@
+#ifndef ANALYTICS_OUTPUT_H
+#define ANALYTICS_OUTPUT_H
+
+#include "data/option_data.h"
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Columnar binary output of per-contract analytics for research tooling.
+//
+// Rows are grouped into fixed-size blocks; inside a block every field is a raw,
+// 8-byte aligned array, so a memory-mapped file can be read through spans
+// without copying or parsing. A block index is written at the end of the file.
+// Values are stored in the native byte order, like the other binary files of
+// the project.
+//
+// The writer fills one block in memory while a background thread writes the
+// previous one (double buffering), so appending a row only copies its fields.
+namespace analytics_output {
+
+    // Number of rows per block unless the writer is told otherwise.
+    inline constexpr std::uint32_t DEFAULT_BLOCK_ROWS = 65536;
+
+    // Trading signal derived from the IV - RV discrepancy.
+    enum class VolatilitySignal : char { Buy = 'B', Sell = 'S', Neutral = 'N' };
+
+    constexpr std::string_view to_string(VolatilitySignal signal) {
+        switch (signal) {
+            case VolatilitySignal::Buy:     return "Buy volatility";
+            case VolatilitySignal::Sell:    return "Sell volatility";
+            case VolatilitySignal::Neutral: return "Neutral";
+            default:                        return "Unknown";
+        }
+    }
+
+    // Analytics of one contract at one time. Greeks are NaN when not computed.
+    // Units: vols and rates as decimals (0.20 = 20%); delta per 1.00 move of the
+    // underlying; vega per 1.00 change in volatility (divide by 100 for per vol
+    // point); theta as price change per year of calendar time (divide by 365 for
+    // per day); rho per 1.00 change in the zero rate.
+    struct AnalyticsRow {
+        std::int64_t timestamp{};
+        double strike_price{};
+        double time_to_expiration{};
+        OptionType type{};
+        double market_price{};
+        double implied_vol{};
+        double realized_vol{};
+        double discrepancy{};      // implied_vol - realized_vol
+        VolatilitySignal signal{VolatilitySignal::Neutral};
+        double delta{};            // d(price)/d(spot)
+        double vega{};             // d(price)/d(volatility)
+        double theta{};            // -d(price)/d(time_to_expiration), i.e., calendar decay per year
+        double rho{};              // d(price)/d(rate)
+    };
+
+    // Read-only view of one block. Spans point into the mapped file.
+    struct AnalyticsBlock {
+        std::span<const std::int64_t> timestamp;
+        std::span<const double> strike_price;
+        std::span<const double> time_to_expiration;
+        std::span<const char> type;     // OptionType values ('C' / 'P')
+        std::span<const double> market_price;
+        std::span<const double> implied_vol;
+        std::span<const double> realized_vol;
+        std::span<const double> discrepancy;
+        std::span<const char> signal;   // VolatilitySignal values ('B' / 'S' / 'N')
+        std::span<const double> delta;
+        std::span<const double> vega;
+        std::span<const double> theta;
+        std::span<const double> rho;
+
+        std::size_t size() const { return timestamp.size(); }
+    };
+
+    // Location of one block, as stored in the file index.
+    struct BlockIndexEntry {
+        std::uint64_t offset{};     // Byte offset of the block in the file
+        std::uint64_t row_count{};  // Number of rows in the block
+    };
+
+    // Appends analytics rows to a new file, writing full blocks on a background thread.
+    class AnalyticsWriter {
+    public:
+        explicit AnalyticsWriter(std::uint32_t block_rows = DEFAULT_BLOCK_ROWS);
+        ~AnalyticsWriter(); // Closes the file if still open
+
+        AnalyticsWriter(const AnalyticsWriter&) = delete;
+        AnalyticsWriter& operator=(const AnalyticsWriter&) = delete;
+
+        // Creates (or truncates) the file, writes the header and starts the
+        // background writer. Returns false if the file cannot be opened.
+        bool open(const std::string& filepath);
+
+        // Appends one row. Only blocks if the previous block is still being written.
+        // Returns false if the writer is not open.
+        bool append(const AnalyticsRow& row);
+
+        // Writes the last partial block and the index, then closes the file.
+        // Returns false if any write failed.
+        bool close();
+
+        bool is_open() const { return is_open_; }
+        std::uint64_t row_count() const { return row_count_; }
+
+    private:
+        struct ColumnBlock {
+            std::vector<std::int64_t> timestamp;
+            std::vector<double> strike_price;
+            std::vector<double> time_to_expiration;
+            std::vector<char> type;
+            std::vector<double> market_price;
+            std::vector<double> implied_vol;
+            std::vector<double> realized_vol;
+            std::vector<double> discrepancy;
+            std::vector<char> signal;
+            std::vector<double> delta;
+            std::vector<double> vega;
+            std::vector<double> theta;
+            std::vector<double> rho;
+
+            std::size_t size() const { return timestamp.size(); }
+            void reserve(std::size_t rows);
+            void clear();
+        };
+
+        void hand_off();            // Passes the filled block to the background thread
+        void run();                 // Background thread
+        void write_block(const ColumnBlock& block);
+
+        std::uint32_t block_rows_;
+        bool is_open_{false};
+        std::uint64_t row_count_{0};
+        std::ofstream file_;
+        ColumnBlock filling_;       // Owned by the appending thread
+        ColumnBlock writing_;       // Owned by the background thread while block_pending_ is set
+        std::vector<BlockIndexEntry> index_;
+        std::uint64_t file_offset_{0};
+
+        std::mutex mutex_;
+        std::condition_variable block_ready_;
+        std::condition_variable block_written_;
+        bool block_pending_{false};
+        bool stopping_{false};
+        bool failed_{false};
+        std::thread thread_;
+    };
+
+    // Memory-maps an analytics file and exposes its blocks as spans.
+    class AnalyticsReader {
+    public:
+        AnalyticsReader() = default;
+        ~AnalyticsReader();
+
+        AnalyticsReader(const AnalyticsReader&) = delete;
+        AnalyticsReader& operator=(const AnalyticsReader&) = delete;
+
+        // Maps the file and validates its header and index.
+        // Returns false if the file cannot be opened or is not a valid analytics file.
+        bool open(const std::string& filepath);
+        void close();
+
+        std::size_t block_count() const { return index_.size(); }
+        std::uint64_t row_count() const { return row_count_; }
+        const std::vector<BlockIndexEntry>& index() const { return index_; }
+
+        // View of block `i`; valid until the reader is closed.
+        AnalyticsBlock block(std::size_t i) const;
+
+    private:
+        const char* data_{nullptr};
+        std::size_t size_{0};
+        std::vector<BlockIndexEntry> index_;
+        std::uint64_t row_count_{0};
+    };
+
+} // namespace analytics_output
+
+#endif // ANALYTICS_OUTPUT_H
@@ -3,6 +3,8 @@
 
 #include "data/market_data.h"
 #include "data/option_data.h"
+#include "data/term_structure.h"
+#include <cstdint>  // For std::uint64_t, SIZE_MAX
 #include <string>
 #include <vector>
 #include <optional> // C++17 feature for optional return values
@@ -19,11 +21,33 @@ namespace data_loader {
     // Returns an empty vector if file cannot be opened or no prices found.
     std::vector<double> load_historical_prices_from_csv(const std::string& filepath);
 
+    // Loads the historical prices that follow a byte offset, e.g., the events after a checkpoint.
+    // offset: 0 to read from the start (the header is skipped); on return, the offset
+    // just past the last line read, to resume from next time.
+    // Only newline-terminated lines are read: a partial last line (a file still being
+    // appended to) is left for the next call.
+    // max_prices: stop after this many prices, so a long history can be replayed in
+    // batches with a resume offset after each one.
+    // Returns an empty vector if file cannot be opened or no new prices found.
+    std::vector<double> load_historical_prices_from_csv(const std::string& filepath, std::uint64_t& offset,
+                                                        std::size_t max_prices = SIZE_MAX);
+
+    // Hash identifying the first `length` bytes of a file: the length plus the bytes at the
+    // start of the file and just before `length`. Store it with a resume offset and compare
+    // on restart to detect a file that was replaced or rewritten rather than appended to.
+    // Returns std::nullopt if the file cannot be opened or is shorter than `length`.
+    std::optional<std::uint64_t> fingerprint_file_prefix(const std::string& filepath, std::uint64_t length);
+
     // Loads option data from a specified CSV file.
     // Expected format: strike_price,time_to_expiration,type,market_price
     // Returns an empty vector if file cannot be opened or no valid options found.
     std::vector<OptionData> load_option_data_from_csv(const std::string& filepath);
 
+    // Loads a zero-rate curve (risk-free rates or dividend yields) from a specified CSV file.
+    // Expected format: tenor,rate (tenor in years, strictly increasing, with a header)
+    // Returns std::nullopt if file cannot be opened, no points are found or tenors are not increasing.
+    std::optional<TermStructure> load_term_structure_from_csv(const std::string& filepath);
+
 } // namespace data_loader
 
 #endif // DATA_LOADER_H
@@ -0,0 +1,59 @@
+#ifndef EXPIRY_FACTORS_H
+#define EXPIRY_FACTORS_H
+
+#include "data/market_data.h"
+#include "data/option_data.h"
+#include "data/term_structure.h"
+#include <vector> // For std::vector
+
+// Expiry-dependent quantities shared by every contract of one expiry.
+// Computing them once per expiry keeps exp/sqrt out of per-contract pricing loops.
+struct ExpiryFactors {
+    double time_to_expiration{};  // Years
+    double discount_factor{1.0};  // exp(-r(T) * T)
+    double dividend_factor{1.0};  // exp(-q(T) * T)
+    double forward{};             // spot * dividend_factor / discount_factor
+    double sqrt_time{};           // sqrt(T)
+    double rate{};                // Zero rate r(T)
+    double dividend_yield{};      // Zero dividend yield q(T)
+};
+
+// Computes the factors for one expiry from rate and dividend curves.
+ExpiryFactors make_expiry_factors(double spot_price, const TermStructure& rates,
+                                  const TermStructure& dividends, double time_to_expiration);
+
+// Computes the factors for one expiry from the flat rate and yield in `market`,
+// as flat curves through the overload above.
+ExpiryFactors make_expiry_factors(const MarketData& market, double time_to_expiration);
+
+// Per-snapshot cache of ExpiryFactors for every distinct expiry of a chain.
+// Rebuild it for each snapshot; the buffers are reused between builds.
+class ExpiryFactorCache {
+public:
+    ExpiryFactorCache() = default;
+
+    // Computes the factors of every distinct expiry in `chain`.
+    void build(double spot_price, const TermStructure& rates, const TermStructure& dividends,
+               const std::vector<OptionData>& chain);
+
+    // Same as above with the flat rate and yield of `market`.
+    void build(const MarketData& market, const std::vector<OptionData>& chain);
+
+    // Factors for chain[contract_index] of the chain the cache was built from.
+    const ExpiryFactors& for_contract(std::size_t contract_index) const {
+        return expiries_[contract_expiry_[contract_index]];
+    }
+
+    // Factors for an expiry, or nullptr if the chain had no contract with that expiry.
+    const ExpiryFactors* find(double time_to_expiration) const;
+
+    // Distinct expiries, in increasing order.
+    const std::vector<ExpiryFactors>& expiries() const { return expiries_; }
+
+private:
+    std::vector<ExpiryFactors> expiries_;
+    std::vector<std::size_t> contract_expiry_;
+    std::vector<double> times_; // Scratch buffer for collecting distinct expiries
+};
+
+#endif // EXPIRY_FACTORS_H
@@ -1,8 +1,10 @@
 #ifndef OPTION_DATA_H
 #define OPTION_DATA_H
 
+#include <cmath>    // For std::llround
 #include <compare>
 #include <concepts>
+#include <cstdint>  // For std::uint64_t
 #include <string_view>
 
 // Option type as enum class for type safety
@@ -28,4 +30,15 @@ constexpr std::string_view to_string(OptionType type) {
     }
 }
 
+// Stable identifier of a contract built from its terms, so a contract keeps its
+// id (and its checkpointed state) when input rows are reordered, added or removed.
+// Packs the type (1 bit), the strike in 0.001 units (32 bits) and the time to
+// expiration in 1e-6 years (31 bits, about 30 seconds).
+inline std::uint64_t option_contract_id(const OptionData& option) {
+    std::uint64_t strike = static_cast<std::uint64_t>(std::llround(option.strike_price * 1e3)) & 0xFFFFFFFFull;
+    std::uint64_t expiry = static_cast<std::uint64_t>(std::llround(option.time_to_expiration * 1e6)) & 0x7FFFFFFFull;
+    std::uint64_t put = option.type == OptionType::Put ? 1 : 0;
+    return (put << 63) | (strike << 31) | expiry;
+}
+
 #endif // OPTION_DATA_H
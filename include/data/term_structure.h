@@ -0,0 +1,36 @@
+#ifndef TERM_STRUCTURE_H
+#define TERM_STRUCTURE_H
+
+#include <vector>    // For std::vector
+#include <stdexcept> // For std::invalid_argument
+
+// Continuously compounded zero-rate curve, used for both risk-free rates and
+// dividend yields. Between tenors r(t) * t is interpolated linearly (piecewise
+// flat forward rates); outside the tenor range the nearest zero rate is held flat.
+class TermStructure {
+public:
+    // Flat curve at 0%.
+    TermStructure() = default;
+
+    // Flat curve at a single rate (e.g., MarketData::risk_free_rate).
+    explicit TermStructure(double flat_rate);
+
+    // Curve through (tenor, rate) points. Tenors are in years and must be
+    // positive and strictly increasing; throws std::invalid_argument otherwise.
+    TermStructure(std::vector<double> tenors, std::vector<double> rates);
+
+    // Zero rate for a maturity in years.
+    double rate(double time) const;
+
+    // exp(-rate(time) * time)
+    double discount_factor(double time) const;
+
+    const std::vector<double>& tenors() const { return tenors_; }
+    const std::vector<double>& rates() const { return rates_; }
+
+private:
+    std::vector<double> tenors_;
+    std::vector<double> rates_;
+};
+
+#endif // TERM_STRUCTURE_H
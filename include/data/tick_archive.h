@@ -0,0 +1,136 @@
+#ifndef TICK_ARCHIVE_H
+#define TICK_ARCHIVE_H
+
+#include "data/option_data.h"
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Compressed columnar archive for intraday option chain histories.
+//
+// Rows are grouped into blocks of at least block_rows rows (except the last).
+// A block is only closed at a snapshot (timestamp) boundary, so it always holds
+// whole snapshots and can run past block_rows by part of one snapshot. Inside
+// a block every field is stored as its own column: timestamps as zigzag varint
+// delta-of-deltas, prices as XOR-encoded doubles (Gorilla style) and the
+// option type as a bitmap.
+// A per-block index (file offset, row count, first/last timestamp) is written
+// at the end of the file so readers can seek to a time range without touching
+// earlier blocks.
+namespace tick_archive {
+
+    // Number of rows per block unless the writer is told otherwise.
+    inline constexpr std::uint32_t DEFAULT_BLOCK_ROWS = 4096;
+
+    // One option quote inside a chain snapshot.
+    struct ChainTick {
+        std::int64_t timestamp{};  // Snapshot time (e.g., milliseconds since epoch)
+        double spot_price{};       // Underlying price at the snapshot
+        OptionData option{};       // Contract and its market price
+    };
+
+    // Columnar batch of decoded rows. Buffers are reused between calls to
+    // TickArchiveReader::next_batch, so keep one batch alive across a replay.
+    struct ChainBatch {
+        std::vector<std::int64_t> timestamps;
+        std::vector<double> spot_prices;
+        std::vector<double> strike_prices;
+        std::vector<double> times_to_expiration;
+        std::vector<OptionType> types;
+        std::vector<double> market_prices;
+
+        std::size_t size() const { return timestamps.size(); }
+        bool empty() const { return timestamps.empty(); }
+
+        // Clears the rows but keeps the allocated capacity.
+        void clear();
+
+        // Resizes every column to `rows` entries.
+        void resize(std::size_t rows);
+
+        // Returns row `i` as a ChainTick.
+        ChainTick row(std::size_t i) const;
+    };
+
+    // Location and time range of one block, as stored in the archive index.
+    struct BlockIndexEntry {
+        std::uint64_t offset{};        // Byte offset of the block in the file
+        std::uint32_t byte_size{};     // Encoded size of the block in bytes
+        std::uint32_t row_count{};     // Number of rows in the block
+        std::int64_t first_timestamp{};
+        std::int64_t last_timestamp{};
+    };
+
+    // Appends chain ticks to a new archive file.
+    // Ticks must be appended in non-decreasing timestamp order.
+    class TickArchiveWriter {
+    public:
+        explicit TickArchiveWriter(std::uint32_t block_rows = DEFAULT_BLOCK_ROWS);
+        ~TickArchiveWriter();
+
+        TickArchiveWriter(const TickArchiveWriter&) = delete;
+        TickArchiveWriter& operator=(const TickArchiveWriter&) = delete;
+
+        // Creates (or truncates) the archive file and writes the header.
+        // Returns false if the file cannot be opened.
+        bool open(const std::string& filepath);
+
+        // Appends one tick; the pending block is written once it is full and
+        // the tick starts a new snapshot. Returns false if the archive is not
+        // open, the timestamp goes backwards or a block cannot be written.
+        bool append(const ChainTick& tick);
+
+        // Flushes the pending block and writes the block index.
+        // Returns false on I/O failure. Called automatically by the destructor.
+        bool close();
+
+        bool is_open() const { return file_.is_open(); }
+
+    private:
+        bool flush_block();
+
+        std::ofstream file_;
+        std::uint32_t block_rows_;
+        ChainBatch pending_;
+        std::vector<std::uint8_t> encoded_;
+        std::vector<BlockIndexEntry> index_;
+        std::uint64_t offset_{0};
+    };
+
+    // Streams snapshot batches out of an archive, one block at a time.
+    class TickArchiveReader {
+    public:
+        TickArchiveReader() = default;
+
+        // Opens the archive and loads its block index.
+        // Returns false if the file cannot be opened or is not a valid archive.
+        bool open(const std::string& filepath);
+
+        // Restricts the replay to ticks with first_timestamp <= timestamp <= last_timestamp.
+        // Blocks that end before first_timestamp are skipped without being read.
+        void seek(std::int64_t first_timestamp, std::int64_t last_timestamp);
+
+        // Decodes the next block that overlaps the selected range into `batch`.
+        // A batch holds whole snapshots: all rows with a given timestamp arrive together.
+        // Returns false once the range is exhausted or on a decoding error.
+        bool next_batch(ChainBatch& batch);
+
+        const std::vector<BlockIndexEntry>& index() const { return index_; }
+
+        // Total number of ticks in the archive.
+        std::uint64_t row_count() const;
+
+    private:
+        std::ifstream file_;
+        std::vector<BlockIndexEntry> index_;
+        std::vector<std::uint8_t> block_buffer_;
+        std::size_t next_block_{0};
+        std::int64_t range_first_{std::numeric_limits<std::int64_t>::min()};
+        std::int64_t range_last_{std::numeric_limits<std::int64_t>::max()};
+    };
+
+} // namespace tick_archive
+
+#endif // TICK_ARCHIVE_H
@@ -3,13 +3,101 @@
 
 #include "data/market_data.h"
 #include "data/option_data.h"
+#include "data/expiry_factors.h"
+#include "utils/math_utils.h" // For normal_cdf
 
-// Calculates the Black-Scholes option price
-double black_scholes_price(double spot_price, double strike_price, double time_to_expiration,
-                           double risk_free_rate, double dividend_yield, double volatility, char type);
+#include <cmath> // For std::log, std::sqrt, std::exp
+
+// Calculates the Black-Scholes option price.
+// Templated on the number type so the same code prices with double and
+// differentiates with adjoint::Real (see utils/adjoint.h).
+template <typename Number>
+Number black_scholes_price(Number spot_price, Number strike_price, Number time_to_expiration,
+                           Number risk_free_rate, Number dividend_yield, Number volatility, OptionType type) {
+    using std::exp;
+    using std::log;
+    using std::sqrt;
+
+    if (time_to_expiration <= 0.0) { // Handle options at or past expiration
+        Number intrinsic = (type == OptionType::Call) ? spot_price - strike_price : strike_price - spot_price;
+        return intrinsic > 0.0 ? intrinsic : Number(0.0);
+    }
+
+    Number spot_discount = spot_price * exp(-dividend_yield * time_to_expiration);
+    Number strike_discount = strike_price * exp(-risk_free_rate * time_to_expiration);
+
+    if (volatility <= 0.0) { // Handle zero or negative volatility
+        // This is a degenerate case, options have no extrinsic value
+        Number intrinsic = (type == OptionType::Call) ? spot_discount - strike_discount : strike_discount - spot_discount;
+        return intrinsic > 0.0 ? intrinsic : Number(0.0);
+    }
+
+    Number vol_sqrt_time = volatility * sqrt(time_to_expiration);
+    Number d1 = (log(spot_price / strike_price) + (risk_free_rate - dividend_yield + 0.5 * volatility * volatility) * time_to_expiration) /
+                vol_sqrt_time;
+    Number d2 = d1 - vol_sqrt_time;
+
+    if (type == OptionType::Call) {
+        return spot_discount * normal_cdf(d1) - strike_discount * normal_cdf(d2);
+    } else { // Put
+        return strike_discount * normal_cdf(-d2) - spot_discount * normal_cdf(-d1);
+    }
+}
+
+// Calculates the Black-Scholes price in forward form from precomputed expiry
+// factors: DF * (F * N(d1) - K * N(d2)). No exp is evaluated per contract, so
+// chains and solvers share one ExpiryFactors per expiry (see ExpiryFactorCache).
+template <typename Number>
+Number black_scholes_price(const ExpiryFactors& factors, Number strike_price, Number volatility, OptionType type) {
+    using std::log;
+
+    Number forward(factors.forward);
+    if (factors.time_to_expiration <= 0.0 || volatility <= 0.0) { // Expired or no extrinsic value
+        Number intrinsic = (type == OptionType::Call) ? forward - strike_price : strike_price - forward;
+        return intrinsic > 0.0 ? factors.discount_factor * intrinsic : Number(0.0);
+    }
+
+    Number vol_sqrt_time = volatility * factors.sqrt_time;
+    Number d1 = log(forward / strike_price) / vol_sqrt_time + 0.5 * vol_sqrt_time;
+    Number d2 = d1 - vol_sqrt_time;
+
+    if (type == OptionType::Call) {
+        return factors.discount_factor * (forward * normal_cdf(d1) - strike_price * normal_cdf(d2));
+    } else { // Put
+        return factors.discount_factor * (strike_price * normal_cdf(-d2) - forward * normal_cdf(-d1));
+    }
+}
+
+// Price and first-order sensitivities from one adjoint (reverse-mode) pass.
+struct BlackScholesSensitivities {
+    double price{};
+    double delta{};          // d(price)/d(spot)
+    double vega{};           // d(price)/d(volatility)
+    double rho{};            // d(price)/d(risk_free_rate)
+    double dividend_rho{};   // d(price)/d(dividend_yield)
+    double theta{};          // d(price)/d(time_to_expiration); negate for calendar-time decay
+    double strike_delta{};   // d(price)/d(strike)
+};
+
+// Calculates the Black-Scholes price and all sensitivities with one forward
+// pass and one backward sweep on a thread-local adjoint tape.
+BlackScholesSensitivities black_scholes_sensitivities(double spot_price, double strike_price, double time_to_expiration,
+                                                      double risk_free_rate, double dividend_yield, double volatility,
+                                                      OptionType type);
+
+// Same sensitivities in closed form from precomputed expiry factors (no tape,
+// no per-contract discounting). rho and dividend_rho are with respect to the
+// zero rates r(T) and q(T); theta holds those rates fixed.
+BlackScholesSensitivities black_scholes_sensitivities(const ExpiryFactors& factors, double strike_price,
+                                                      double volatility, OptionType type);
 
 // Calculates implied volatility using the bisection method
 double implied_volatility_bisection(const OptionData& option, const MarketData& market,
                                     double tolerance = 1e-5, int max_iterations = 100);
 
+// Same as above with the expiry factors of option.time_to_expiration already
+// computed; use with ExpiryFactorCache when solving a whole chain.
+double implied_volatility_bisection(const OptionData& option, const ExpiryFactors& factors,
+                                    double tolerance = 1e-5, int max_iterations = 100);
+
 #endif // BLACK_SCHOLES_H
@@ -0,0 +1,65 @@
+#ifndef HESTON_H
+#define HESTON_H
+
+#include "data/expiry_factors.h"
+#include "data/market_data.h"
+#include "data/option_data.h"
+#include "data/term_structure.h"
+#include <vector> // For std::vector
+
+// Heston stochastic-volatility model parameters.
+struct HestonParameters {
+    double initial_variance{0.04};   // v0: current instantaneous variance
+    double long_run_variance{0.04};  // theta: variance the process reverts to
+    double correlation{-0.7};        // rho: correlation between spot and variance shocks
+    double mean_reversion{1.5};      // kappa: speed of reversion to long_run_variance
+    double vol_of_vol{0.5};          // sigma: volatility of variance
+};
+
+// Calculates the Heston price of one option by integrating the characteristic
+// function on adaptively bisected Gauss-Legendre panels. Prices are floored at
+// the discounted intrinsic forward value. `factors` must be for the option's expiry.
+double heston_price(const OptionData& option, const ExpiryFactors& factors, const HestonParameters& params);
+
+// Same as above with the flat rate and yield of `market`.
+double heston_price(const OptionData& option, const MarketData& market, const HestonParameters& params);
+
+// Prices a whole chain. The discount factor and forward of each distinct expiry
+// are read from the rate and dividend curves once, and strike-independent
+// integrand terms are computed once per expiry and shared by all its strikes.
+std::vector<double> heston_prices(const std::vector<OptionData>& chain, double spot_price, const TermStructure& rates,
+                                  const TermStructure& dividends, const HestonParameters& params);
+
+// Same as above with the flat rate and yield of `market`.
+std::vector<double> heston_prices(const std::vector<OptionData>& chain, const MarketData& market,
+                                  const HestonParameters& params);
+
+struct HestonCalibrationOptions {
+    int max_iterations{100};       // Levenberg-Marquardt iterations
+    double tolerance{1e-10};       // Stop when the relative improvement of the squared error falls below this,
+                                   // or the largest relative parameter step below its square root
+    unsigned threads{0};           // Worker threads for chain evaluation (0 = hardware concurrency)
+};
+
+struct HestonCalibrationResult {
+    HestonParameters parameters;
+    double rmse{0.0};              // Root mean squared price error at the solution
+    int iterations{0};
+    bool converged{false};
+};
+
+// Calibrates Heston parameters to the market prices of a chain with
+// Levenberg-Marquardt, using exact gradients of the model prices.
+// Contracts are priced in parallel; parameters are kept inside a feasible box.
+// Expiry factors come from the curves once and are reused by every iteration.
+HestonCalibrationResult calibrate_heston(const std::vector<OptionData>& chain, double spot_price,
+                                         const TermStructure& rates, const TermStructure& dividends,
+                                         const HestonParameters& initial_guess,
+                                         const HestonCalibrationOptions& options = {});
+
+// Same as above with the flat rate and yield of `market`.
+HestonCalibrationResult calibrate_heston(const std::vector<OptionData>& chain, const MarketData& market,
+                                         const HestonParameters& initial_guess,
+                                         const HestonCalibrationOptions& options = {});
+
+#endif // HESTON_H
@@ -0,0 +1,177 @@
+#ifndef RISK_ENGINE_H
+#define RISK_ENGINE_H
+
+#include <atomic>      // For std::atomic
+#include <cstddef>     // For std::size_t
+#include <cstdint>     // For std::uint64_t
+#include <memory>      // For std::unique_ptr
+#include <string_view> // For std::string_view
+
+// Exposure limits of one underlying. Limits apply to the absolute net exposure.
+struct UnderlyingLimits {
+    double max_abs_delta{};  // Net delta, in underlying units
+    double max_abs_vega{};   // Net vega, in currency per vol point
+};
+
+// Exposure change a trade would add to the book. Closing trades carry the
+// opposite sign of the position they reduce.
+struct TradeRequest {
+    std::size_t underlying{};  // Id returned by RiskEngine::add_underlying
+    std::uint64_t contract_id{}; // Caller-defined stable identifier of the contract (not UINT64_MAX)
+    double quantity{};         // Signed quantity traded
+    double capital{};          // Premium or margin committed (negative when released)
+    double delta{};
+    double vega{};
+    double max_loss{};         // Worst-case loss of the trade (e.g., premium paid for a long option)
+};
+
+enum class RiskCheckResult : char {
+    Accepted,
+    CapitalLimit,
+    LossLimit,
+    DeltaLimit,
+    VegaLimit,
+    UnknownUnderlying,   // Or the contract is already booked under another underlying
+    PositionBookFull     // No room for another contract
+};
+
+constexpr std::string_view to_string(RiskCheckResult result) {
+    switch (result) {
+        case RiskCheckResult::Accepted:          return "Accepted";
+        case RiskCheckResult::CapitalLimit:      return "Capital limit";
+        case RiskCheckResult::LossLimit:         return "Loss limit";
+        case RiskCheckResult::DeltaLimit:        return "Delta limit";
+        case RiskCheckResult::VegaLimit:         return "Vega limit";
+        case RiskCheckResult::UnknownUnderlying: return "Unknown underlying";
+        case RiskCheckResult::PositionBookFull:  return "Position book full";
+        default:                                 return "Unknown";
+    }
+}
+
+// Snapshot of the book's exposure in one underlying.
+struct UnderlyingExposure {
+    double delta{};
+    double vega{};
+    double capital{};
+};
+
+// Net position of one contract: the sum of its accepted, unreleased trades.
+struct ContractPosition {
+    std::size_t underlying{};
+    double quantity{};
+    double delta{};
+    double vega{};
+    double capital{};
+    double max_loss{};
+};
+
+// Shared position and exposure book with pre-trade limit checks.
+//
+// Strategy threads call reserve() before sending an order; it checks capital,
+// max-loss and the underlying's delta/vega limits and applies the trade in the
+// same step, so two threads can never both fit into the same headroom. All
+// checks are O(1):
+//   - book-wide capital and loss are atomics updated with compare-and-swap loops;
+//   - delta and vega of one underlying are checked and updated together under
+//     that underlying's spin lock, held for a few instructions. Each underlying
+//     sits on its own cache line, so threads trading different underlyings do
+//     not contend.
+//
+// Every accepted trade is also added to its contract's net position, kept in a
+// fixed-capacity open-addressing table whose slots are claimed with a
+// compare-and-swap on the contract id. A contract takes a slot only when its
+// first trade is accepted, and at most max_contracts slots are ever taken, so the
+// table stays at most half full. close_position() releases whatever a contract
+// still holds, so callers do not need to keep the trades they reserved.
+//
+// Trades that reduce an exposure are always accepted for that exposure, even
+// if the book is already over the limit.
+//
+// add_underlying() is a set-up step and must finish before trading threads start.
+class RiskEngine {
+public:
+    // total_capital: capital the book may commit across all strategies.
+    // max_loss: limit on reserved worst-case losses plus realized losses.
+    // max_underlyings: capacity of the book.
+    // max_contracts: distinct contracts the position book can hold; trades on further
+    //   contracts are rejected with PositionBookFull (slots are never reused).
+    RiskEngine(double total_capital, double max_loss, std::size_t max_underlyings = 256,
+               std::size_t max_contracts = 16384);
+
+    RiskEngine(const RiskEngine&) = delete;
+    RiskEngine& operator=(const RiskEngine&) = delete;
+
+    // Registers an underlying and returns its id, or max_underlyings() if the book is full.
+    std::size_t add_underlying(const UnderlyingLimits& limits);
+
+    // Checks a trade against every limit without changing the book.
+    RiskCheckResult check(const TradeRequest& trade) const;
+
+    // Checks a trade and, if every limit holds, adds it to the book.
+    // On rejection the book is left unchanged.
+    RiskCheckResult reserve(const TradeRequest& trade);
+
+    // Removes a previously reserved trade, or part of one (order cancelled or partly filled).
+    void release(const TradeRequest& trade);
+
+    // Releases everything still booked for a contract (position closed) and
+    // returns what was released; all zero for an unknown contract.
+    ContractPosition close_position(std::uint64_t contract_id);
+
+    // Current net position of a contract; all zero for an unknown contract.
+    ContractPosition position(std::uint64_t contract_id) const;
+
+    // Records realized P&L; losses count toward the max-loss limit.
+    void record_pnl(double pnl);
+
+    double used_capital() const { return used_capital_.load(std::memory_order_relaxed); }
+    double available_capital() const { return total_capital_ - used_capital(); }
+    double reserved_loss() const { return reserved_loss_.load(std::memory_order_relaxed); }
+    double realized_pnl() const { return realized_pnl_.load(std::memory_order_relaxed); }
+
+    UnderlyingExposure exposure(std::size_t underlying) const;
+
+    std::size_t underlying_count() const { return underlying_count_; }
+    std::size_t max_underlyings() const { return max_underlyings_; }
+    std::size_t contract_count() const { return contract_count_.load(std::memory_order_relaxed); }
+    std::size_t max_contracts() const { return max_contracts_; }
+
+private:
+    // One cache line per underlying so updates to different underlyings do not false-share.
+    struct alignas(64) UnderlyingSlot {
+        UnderlyingLimits limits;
+        mutable std::atomic_flag lock = ATOMIC_FLAG_INIT; // Guards delta/vega check-and-update and the positions of its contracts
+        std::atomic<double> delta{0.0};           // Atomic so readers need not take the lock
+        std::atomic<double> vega{0.0};
+        std::atomic<double> capital{0.0};
+    };
+
+    static constexpr std::size_t NO_UNDERLYING = static_cast<std::size_t>(-1);
+
+    struct ContractSlot {
+        std::atomic<std::uint64_t> key{0};                 // contract_id + 1; 0 while the slot is free
+        std::atomic<std::size_t> underlying{NO_UNDERLYING}; // Set once, right after the key is claimed
+        ContractPosition position;                         // Guarded by the underlying's lock
+    };
+
+    double loss_headroom() const;
+    ContractSlot* find_contract(std::uint64_t contract_id, bool insert) const;
+    bool contract_underlying(ContractSlot& contract, std::size_t underlying) const;
+
+    double total_capital_;
+    double max_loss_;
+    std::size_t max_underlyings_;
+    std::size_t underlying_count_{0};
+    std::unique_ptr<UnderlyingSlot[]> underlyings_;
+    std::size_t max_contracts_;
+    std::size_t contract_mask_;                   // Table size - 1 (size is a power of two, at least 2 * max_contracts_)
+    std::unique_ptr<ContractSlot[]> contracts_;
+
+    // Book-wide counters, each on its own cache line
+    alignas(64) std::atomic<double> used_capital_{0.0};
+    alignas(64) std::atomic<double> reserved_loss_{0.0};
+    alignas(64) std::atomic<double> realized_pnl_{0.0};
+    alignas(64) mutable std::atomic<std::size_t> contract_count_{0}; // Claimed contract slots, never above max_contracts_
+};
+
+#endif // RISK_ENGINE_H
@@ -1,7 +1,9 @@
 #ifndef VOLATILITY_FORECAST_H
 #define VOLATILITY_FORECAST_H
 
-#include <vector> // For std::vector
+#include <cstddef> // For std::size_t
+#include <cstdint> // For std::uint64_t
+#include <vector>  // For std::vector
 
 // Calculates historical volatility from a series of historical prices.
 // Assumes prices are daily closing prices.
@@ -9,4 +11,48 @@
 // period: the number of trading days in a year (e.g., 252 for daily data)
 double calculate_historical_volatility(const std::vector<double>& prices, int period = 252);
 
+// Incremental version of calculate_historical_volatility for streaming prices.
+// Keeps a running mean and sum of squared deviations of log returns (Welford),
+// so each new price costs O(1) instead of a pass over the whole history.
+// window: number of most recent returns used (0 = every return seen so far).
+class RollingVolatility {
+public:
+    // Everything needed to resume the estimator, e.g., from a checkpoint.
+    struct State {
+        std::uint64_t window{0};
+        int period{252};
+        double last_price{0.0};      // 0 before the first price
+        std::uint64_t count{0};      // Returns currently in the estimate
+        double mean{0.0};            // Mean of those returns
+        double sum_sq_diff{0.0};     // Sum of squared deviations from the mean
+        std::vector<double> returns; // Returns in the window, oldest first (empty if window is 0)
+    };
+
+    explicit RollingVolatility(std::size_t window = 0, int period = 252);
+
+    // Adds the next price of the series.
+    void add_price(double price);
+
+    // Annualized sample volatility of the returns in the window; 0 with fewer than 2 returns.
+    double volatility() const;
+
+    std::uint64_t return_count() const { return count_; }
+
+    State state() const;
+    void restore(const State& state);
+
+private:
+    void add_return(double value);
+    void remove_return(double value);
+
+    std::size_t window_;
+    int period_;
+    double last_price_{0.0};
+    std::uint64_t count_{0};
+    double mean_{0.0};
+    double sum_sq_diff_{0.0};
+    std::vector<double> ring_;  // Last `window_` returns; ring_head_ is the oldest once full
+    std::size_t ring_head_{0};
+};
+
 #endif // VOLATILITY_FORECAST_H
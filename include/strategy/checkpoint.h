@@ -0,0 +1,76 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "strategy/implied_vol_strategy.h"
+#include <condition_variable> // For std::condition_variable
+#include <cstdint>            // For std::uint64_t
+#include <mutex>              // For std::mutex
+#include <optional>           // For std::optional
+#include <string>             // For std::string
+#include <thread>             // For std::thread
+
+// Binary checkpoints of strategy state for fast restart.
+//
+// A checkpoint holds the strategy, estimator, surface and position state plus
+// the position in the event source it was taken at. On startup the latest
+// checkpoint is restored and only the events after source_offset are replayed,
+// so recovery time depends on the events since the checkpoint, not on the
+// length of the history. source_fingerprint identifies the price file the
+// offset refers to; if the file no longer matches it, the checkpoint must be
+// discarded and the history replayed in full.
+//
+// Files are written to "<path>.tmp" and renamed into place, so a crash while
+// writing leaves the previous checkpoint intact. The payload carries a
+// checksum; files use the native byte order.
+namespace checkpoint {
+
+    struct Checkpoint {
+        StrategyState strategy;
+        std::uint64_t source_offset{0};       // Byte offset in the price file after the last applied event
+        std::uint64_t source_fingerprint{0};  // data_loader::fingerprint_file_prefix(price file, source_offset)
+    };
+
+    // Writes a checkpoint file. Returns false on failure.
+    bool write_checkpoint(const std::string& filepath, const Checkpoint& checkpoint);
+
+    // Reads a checkpoint file. Returns std::nullopt if it is missing, truncated or corrupt.
+    std::optional<Checkpoint> read_checkpoint(const std::string& filepath);
+
+    // Writes checkpoints on a background thread so analysis is not paused.
+    // If checkpoints are submitted faster than they can be written, only the
+    // latest pending one is kept.
+    class CheckpointWriter {
+    public:
+        explicit CheckpointWriter(std::string filepath);
+        ~CheckpointWriter(); // Writes the pending checkpoint, if any, then stops
+
+        CheckpointWriter(const CheckpointWriter&) = delete;
+        CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+        // Queues a checkpoint and returns immediately.
+        void submit(Checkpoint checkpoint);
+
+        // Blocks until every submitted checkpoint has been written.
+        void flush();
+
+        std::uint64_t written_count() const;
+        std::uint64_t failed_count() const;
+
+    private:
+        void run();
+
+        std::string filepath_;
+        mutable std::mutex mutex_;
+        std::condition_variable work_ready_;
+        std::condition_variable work_done_;
+        std::optional<Checkpoint> pending_;
+        bool writing_{false};
+        bool stopping_{false};
+        std::uint64_t written_count_{0};
+        std::uint64_t failed_count_{0};
+        std::thread thread_;  // Started last, after every member it uses
+    };
+
+} // namespace checkpoint
+
+#endif // CHECKPOINT_H
@@ -4,18 +4,98 @@
 
 #include "data/market_data.h"
 #include "data/option_data.h"
+#include "data/analytics_output.h"
+#include "data/expiry_factors.h"
+#include "models/heston.h"
+#include "models/volatility_forecast.h"
 #include "strategy.h"
-#include <vector> // For std::vector
+#include <cstdint>  // For std::uint64_t
+#include <map>      // For std::map
+#include <optional> // For std::optional
+#include <vector>   // For std::vector
 
-class ImpliedVolStrategy {
+// Per-contract state carried between analyses.
+struct ContractState {
+    std::uint64_t contract_id{};   // Caller-defined stable identifier of the contract
+    double last_implied_vol{0.0};  // IV from the most recent analysis
+    double position{0.0};          // Net quantity held
+    double average_price{0.0};     // Average entry price of the open position
+};
+
+// Everything the strategy needs to resume after a restart (see strategy/checkpoint.h).
+struct StrategyState {
+    std::uint64_t events_applied{0};        // Prices fed through on_price so far
+    RollingVolatility::State realized_vol;
+    std::optional<HestonParameters> surface;
+    std::vector<ContractState> contracts;   // Ordered by contract_id
+};
+
+class ImpliedVolStrategy : public Strategy {
 public:
+    // rv_window: returns used by the streaming RV estimate (0 = all prices seen).
+    explicit ImpliedVolStrategy(std::size_t rv_window = 0);
+
     // Analyzes a given option and market data to generate a trading signal.
     // option: the option contract to analyze
     // market: current market data for the underlying
     // historical_prices: vector of historical prices for volatility forecasting
     void analyze(const OptionData& option, 
                  const MarketData& market,
-                 const std::vector<double>& historical_prices)override;
+                 const std::vector<double>& historical_prices) override;
+
+    // Streaming interface: prices are fed one at a time and the RV estimate is
+    // kept up to date incrementally, so analysis does not rescan the history.
+    void on_price(double price);
+
+    // Analyzes a contract against the streaming RV estimate and records its IV.
+    // factors: discounting and forward of the contract's expiry, e.g., from an
+    // ExpiryFactorCache built once per chain snapshot.
+    void analyze(std::uint64_t contract_id, const OptionData& option, const ExpiryFactors& factors);
+
+    // Books a fill of `quantity` (negative to sell) at `price`.
+    void record_fill(std::uint64_t contract_id, double quantity, double price);
+
+    // Latest calibrated volatility surface parameters.
+    void set_surface(const HestonParameters& params) { surface_ = params; }
+    const std::optional<HestonParameters>& surface() const { return surface_; }
+
+    // Appends one analytics row (IV, RV, discrepancy, signal and Greeks) per
+    // analyzed contract to `writer`; nullptr stops the output. The writer must
+    // outlive the strategy or be detached first.
+    void set_analytics_writer(analytics_output::AnalyticsWriter* writer) { analytics_writer_ = writer; }
+
+    // Whether analytics rows carry closed-form Greeks at the IV (off by default,
+    // so the Greek columns are NaN). Turning them on adds one closed-form
+    // sensitivity evaluation per analyzed contract.
+    void set_analytics_greeks(bool enabled) { analytics_greeks_ = enabled; }
+
+    // Timestamp stamped on analytics rows (e.g., the time of the chain snapshot).
+    void set_timestamp(std::int64_t timestamp) { timestamp_ = timestamp; }
+
+    // Turns the per-contract console report on or off (on by default).
+    void set_verbose(bool verbose) { verbose_ = verbose; }
+
+    double realized_volatility() const { return realized_vol_.volatility(); }
+    std::uint64_t events_applied() const { return events_applied_; }
+
+    // Copies the full state; cheap enough to call between events.
+    StrategyState state() const;
+    void restore(const StrategyState& state);
+
+private:
+    using VolatilitySignal = analytics_output::VolatilitySignal;
+
+    void report(const OptionData& option, const ExpiryFactors& factors,
+                double implied_vol, double forecasted_realized_vol);
+
+    RollingVolatility realized_vol_;
+    std::uint64_t events_applied_{0};
+    std::optional<HestonParameters> surface_;
+    std::map<std::uint64_t, ContractState> contracts_;
+    analytics_output::AnalyticsWriter* analytics_writer_{nullptr};
+    std::int64_t timestamp_{0};
+    bool analytics_greeks_{false};
+    bool verbose_{true};
 };
 
 #endif // IMPLIED_VOL_STRATEGY_H
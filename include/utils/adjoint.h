@@ -0,0 +1,247 @@
+#ifndef ADJOINT_H
+#define ADJOINT_H
+
+#include <cmath>    // For std::exp, std::log, std::sqrt, std::erf
+#include <cstddef>  // For std::size_t
+#include <cstdint>  // For std::uint32_t
+#include <memory>   // For std::unique_ptr
+#include <vector>   // For std::vector
+
+// Tape-based reverse-mode algorithmic differentiation.
+//
+// Pricers templated on the number type (see black_scholes_price) can be run
+// with adjoint::Real instead of double. Every operation on a Real that depends
+// on a tape input is recorded on the active tape; one backward sweep then gives
+// the derivative of the output with respect to every input at once, instead of
+// one bump-and-reprice per input.
+//
+// Each Real remembers which tape (and which recording since its last rewind)
+// its node belongs to. Combining it with no tape active, under another tape, or
+// after that tape was rewound throws std::logic_error instead of silently
+// recording a wrong graph.
+//
+// Usage:
+//   adjoint::Tape tape;
+//   adjoint::ActiveTape recording(tape);
+//   adjoint::Real spot = tape.input(100.0), vol = tape.input(0.2);
+//   adjoint::Real price = black_scholes_price<adjoint::Real>(spot, ..., vol, OptionType::Call);
+//   tape.propagate(price);
+//   double delta = tape.adjoint(spot), vega = tape.adjoint(vol);
+namespace adjoint {
+
+    inline constexpr std::uint32_t NO_NODE = 0xFFFFFFFFu;
+    inline constexpr std::uint32_t NO_TAPE = 0;
+
+    class Real;
+
+    // Records operations in an arena of fixed-size node blocks. rewind() keeps the
+    // blocks, so a tape reused across evaluations stops allocating after warm-up.
+    class Tape {
+    public:
+        Tape();
+        ~Tape();
+
+        Tape(const Tape&) = delete;
+        Tape& operator=(const Tape&) = delete;
+
+        // Makes this tape the one new operations are recorded on (per thread).
+        void activate();
+
+        // Stops recording on the current thread if this tape is active.
+        void deactivate();
+
+        // Tape operations on the current thread are recorded on, or nullptr.
+        static Tape* active();
+
+        // The active tape, if operands recorded under `tape_id` may be recorded on it;
+        // throws std::logic_error otherwise.
+        static Tape& recording(std::uint32_t tape_id);
+
+        // Identifies this tape and its current recording; changes on rewind().
+        std::uint32_t id() const { return id_; }
+
+        // Registers an independent variable.
+        Real input(double value);
+
+        // Runs the backward sweep with d(output)/d(output) = 1.
+        void propagate(const Real& output);
+
+        // d(output)/d(x) from the last propagate() call; 0 for constants.
+        double adjoint(const Real& x) const;
+
+        // Forgets all recorded operations but keeps the arena memory. Reals
+        // recorded before can no longer be used with this tape.
+        void rewind();
+
+        // Number of recorded nodes.
+        std::size_t size() const { return size_; }
+
+        // Appends a node with up to two parents (NO_NODE for constants) and the
+        // partial derivatives of the node with respect to each of them.
+        std::uint32_t record(std::uint32_t parent0, double partial0,
+                             std::uint32_t parent1 = NO_NODE, double partial1 = 0.0);
+
+    private:
+        struct Node {
+            std::uint32_t parent[2];
+            double partial[2];
+        };
+
+        static constexpr std::size_t BLOCK_SHIFT = 12;
+        static constexpr std::size_t BLOCK_NODES = std::size_t{1} << BLOCK_SHIFT;
+
+        Node& node(std::size_t index) {
+            return blocks_[index >> BLOCK_SHIFT][index & (BLOCK_NODES - 1)];
+        }
+
+        std::vector<std::unique_ptr<Node[]>> blocks_;
+        std::size_t size_{0};
+        std::uint32_t id_;
+        std::vector<double> adjoints_;
+    };
+
+    // Activates a tape for the current scope and reactivates whichever tape was
+    // active before (or none) on exit, so library code can record on its own
+    // tape without ending a caller's recording.
+    class ActiveTape {
+    public:
+        explicit ActiveTape(Tape& tape) : tape_(tape), previous_(Tape::active()) { tape_.activate(); }
+        ~ActiveTape() {
+            tape_.deactivate();
+            if (previous_ != nullptr) previous_->activate();
+        }
+
+        ActiveTape(const ActiveTape&) = delete;
+        ActiveTape& operator=(const ActiveTape&) = delete;
+
+    private:
+        Tape& tape_;
+        Tape* previous_;
+    };
+
+    // Active number: a value plus the tape node it was computed at and the id of
+    // that tape. Reals built from plain doubles are constants and are never recorded.
+    class Real {
+    public:
+        Real() = default;
+        Real(double value) : value_(value) {} // Implicit so literals and double inputs mix freely
+
+        double value() const { return value_; }
+        std::uint32_t node() const { return node_; }
+        std::uint32_t tape() const { return tape_; }
+
+        Real& operator+=(const Real& other);
+        Real& operator-=(const Real& other);
+        Real& operator*=(const Real& other);
+        Real& operator/=(const Real& other);
+
+        // Builds the result of an operation: recorded only if an operand is on a tape.
+        static Real unary(double value, const Real& a, double da) {
+            Real result(value);
+            if (a.node_ != NO_NODE) {
+                Tape& tape = Tape::recording(a.tape_);
+                result.node_ = tape.record(a.node_, da);
+                result.tape_ = a.tape_;
+            }
+            return result;
+        }
+
+        static Real binary(double value, const Real& a, double da, const Real& b, double db) {
+            Real result(value);
+            if (a.node_ != NO_NODE || b.node_ != NO_NODE) {
+                std::uint32_t tape_id = a.node_ != NO_NODE ? a.tape_ : b.tape_;
+                if (a.node_ != NO_NODE && b.node_ != NO_NODE && a.tape_ != b.tape_) {
+                    tape_id = NO_TAPE; // Operands from different tapes: recording() throws
+                }
+                Tape& tape = Tape::recording(tape_id);
+                result.node_ = tape.record(a.node_, da, b.node_, db);
+                result.tape_ = tape_id;
+            }
+            return result;
+        }
+
+    private:
+        friend class Tape;
+
+        double value_{0.0};
+        std::uint32_t node_{NO_NODE};
+        std::uint32_t tape_{NO_TAPE};
+    };
+
+    // --- Arithmetic ---
+
+    inline Real operator+(const Real& a, const Real& b) {
+        return Real::binary(a.value() + b.value(), a, 1.0, b, 1.0);
+    }
+
+    inline Real operator-(const Real& a, const Real& b) {
+        return Real::binary(a.value() - b.value(), a, 1.0, b, -1.0);
+    }
+
+    inline Real operator*(const Real& a, const Real& b) {
+        return Real::binary(a.value() * b.value(), a, b.value(), b, a.value());
+    }
+
+    inline Real operator/(const Real& a, const Real& b) {
+        double inverse = 1.0 / b.value();
+        double result = a.value() * inverse;
+        return Real::binary(result, a, inverse, b, -result * inverse);
+    }
+
+    inline Real operator-(const Real& a) {
+        return Real::unary(-a.value(), a, -1.0);
+    }
+
+    inline Real operator+(const Real& a) {
+        return a;
+    }
+
+    inline Real& Real::operator+=(const Real& other) { return *this = *this + other; }
+    inline Real& Real::operator-=(const Real& other) { return *this = *this - other; }
+    inline Real& Real::operator*=(const Real& other) { return *this = *this * other; }
+    inline Real& Real::operator/=(const Real& other) { return *this = *this / other; }
+
+    // --- Comparisons (on values; branches are not differentiated) ---
+
+    inline bool operator==(const Real& a, const Real& b) { return a.value() == b.value(); }
+    inline bool operator!=(const Real& a, const Real& b) { return a.value() != b.value(); }
+    inline bool operator<(const Real& a, const Real& b) { return a.value() < b.value(); }
+    inline bool operator<=(const Real& a, const Real& b) { return a.value() <= b.value(); }
+    inline bool operator>(const Real& a, const Real& b) { return a.value() > b.value(); }
+    inline bool operator>=(const Real& a, const Real& b) { return a.value() >= b.value(); }
+
+    // --- Elementary functions (found by argument-dependent lookup) ---
+
+    inline Real exp(const Real& x) {
+        double value = std::exp(x.value());
+        return Real::unary(value, x, value);
+    }
+
+    inline Real log(const Real& x) {
+        return Real::unary(std::log(x.value()), x, 1.0 / x.value());
+    }
+
+    inline Real sqrt(const Real& x) {
+        double value = std::sqrt(x.value());
+        return Real::unary(value, x, 0.5 / value);
+    }
+
+    inline Real abs(const Real& x) {
+        return Real::unary(std::abs(x.value()), x, x.value() < 0.0 ? -1.0 : 1.0);
+    }
+
+    inline Real erf(const Real& x) {
+        constexpr double TWO_OVER_SQRT_PI = 1.1283791670955126;
+        return Real::unary(std::erf(x.value()), x, TWO_OVER_SQRT_PI * std::exp(-x.value() * x.value()));
+    }
+
+    // Standard normal CDF recorded as a single node (derivative is the normal PDF).
+    inline Real normal_cdf(const Real& x) {
+        constexpr double INV_SQRT_2PI = 0.3989422804014327;
+        double value = 0.5 * (1.0 + std::erf(x.value() / std::sqrt(2.0)));
+        return Real::unary(value, x, INV_SQRT_2PI * std::exp(-0.5 * x.value() * x.value()));
+    }
+
+} // namespace adjoint
+
+#endif // ADJOINT_H
@@ -7,4 +7,7 @@
 // This is an approximation for erf. For production, use a more robust library.
 double normal_cdf(double x);
 
+// Standard normal probability density function (PDF)
+double normal_pdf(double x);
+
 #endif // MATH_UTILS_H
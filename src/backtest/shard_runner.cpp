@@ -0,0 +1,350 @@
+#include "backtest/shard_runner.h"
+#include <algorithm>    // For std::sort, std::min, std::max
+#include <cerrno>       // For errno, EINTR
+#include <chrono>       // For std::chrono::milliseconds
+#include <cstdio>       // For std::rename, std::remove, std::fflush
+#include <fstream>      // For binary result files
+#include <iostream>     // For error messages
+#include <map>          // For ordered carried positions
+#include <set>          // For duplicate shard detection
+#include <thread>       // For std::thread::hardware_concurrency, std::this_thread::sleep_for
+#include <type_traits>  // For std::is_trivially_copyable_v
+
+#include <sys/types.h>  // For pid_t
+#include <sys/wait.h>   // For waitpid
+#include <unistd.h>     // For fork, _exit
+
+namespace backtest {
+
+    namespace {
+
+        constexpr char RESULT_MAGIC[4] = {'V', 'T', 'S', 'R'};
+        constexpr std::uint32_t RESULT_VERSION = 1;
+
+        // Result files use the native byte order; every host sharing storage is
+        // expected to run the same build.
+        template <typename T>
+        void write_value(std::ofstream& out, const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template <typename T>
+        bool read_value(std::ifstream& in, T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+        }
+
+        // Reads a count and rejects values that cannot fit in the rest of the file.
+        bool read_count(std::ifstream& in, std::uint64_t remaining_bytes, std::size_t element_size, std::uint64_t& count) {
+            return read_value(in, count) && count <= remaining_bytes / element_size;
+        }
+
+        std::uint64_t remaining(std::ifstream& in, std::uint64_t file_size) {
+            std::uint64_t position = static_cast<std::uint64_t>(in.tellg());
+            return position <= file_size ? file_size - position : 0;
+        }
+
+        bool shard_before(const ShardResult& a, const ShardResult& b) {
+            if (a.spec.symbol != b.spec.symbol) return a.spec.symbol < b.spec.symbol;
+            if (a.spec.first_timestamp != b.spec.first_timestamp) return a.spec.first_timestamp < b.spec.first_timestamp;
+            return a.spec.index < b.spec.index;
+        }
+
+        struct CarriedPosition {
+            double quantity{0.0};
+            double last_mark{0.0};
+        };
+
+        // P&L point tagged with its merge order so equal timestamps are summed identically every run.
+        struct OrderedPnl {
+            std::int64_t timestamp;
+            std::size_t order;
+            double pnl;
+        };
+
+    } // namespace
+
+    std::vector<ShardSpec> make_shards(const std::vector<std::string>& symbols,
+                                       std::int64_t first_timestamp, std::int64_t last_timestamp,
+                                       std::int64_t shard_length) {
+        std::vector<ShardSpec> shards;
+        if (shard_length <= 0 || last_timestamp < first_timestamp) {
+            std::cerr << "Warning: Invalid shard range or length. No shards created." << std::endl;
+            return shards;
+        }
+
+        for (const std::string& symbol : symbols) {
+            std::int64_t start = first_timestamp;
+            while (true) {
+                std::int64_t end = (last_timestamp - start < shard_length) ? last_timestamp : start + shard_length - 1;
+                shards.push_back(ShardSpec{static_cast<std::uint32_t>(shards.size()), symbol, start, end});
+                if (end == last_timestamp) break;
+                start = end + 1;
+            }
+        }
+        return shards;
+    }
+
+    std::string shard_result_path(const std::string& directory, const ShardSpec& spec) {
+        return directory + "/shard_" + std::to_string(spec.index) + ".vtsr";
+    }
+
+    bool write_shard_result(const std::string& filepath, const ShardResult& result) {
+        const std::string temp_path = filepath + ".tmp";
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                std::cerr << "Error: Could not create shard result file: " << temp_path << std::endl;
+                return false;
+            }
+
+            out.write(RESULT_MAGIC, sizeof(RESULT_MAGIC));
+            write_value(out, RESULT_VERSION);
+            write_value(out, result.spec.index);
+            write_value(out, static_cast<std::uint32_t>(result.spec.symbol.size()));
+            out.write(result.spec.symbol.data(), static_cast<std::streamsize>(result.spec.symbol.size()));
+            write_value(out, result.spec.first_timestamp);
+            write_value(out, result.spec.last_timestamp);
+            write_value(out, result.trade_count);
+            write_value(out, result.rows_processed);
+
+            write_value(out, static_cast<std::uint64_t>(result.pnl.size()));
+            for (const PnlPoint& point : result.pnl) {
+                write_value(out, point.timestamp);
+                write_value(out, point.pnl);
+            }
+            write_value(out, static_cast<std::uint64_t>(result.contracts.size()));
+            for (const ContractActivity& contract : result.contracts) {
+                write_value(out, contract.contract_id);
+                write_value(out, contract.quantity_change);
+                write_value(out, contract.last_mark);
+            }
+
+            out.flush();
+            if (!out.good()) {
+                std::cerr << "Error: Failed to write shard result file: " << temp_path << std::endl;
+                return false;
+            }
+        }
+
+        if (std::rename(temp_path.c_str(), filepath.c_str()) != 0) {
+            std::cerr << "Error: Could not move shard result into place: " << filepath << std::endl;
+            std::remove(temp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    std::optional<ShardResult> read_shard_result(const std::string& filepath) {
+        std::ifstream in(filepath, std::ios::binary | std::ios::ate);
+        if (!in.is_open()) {
+            std::cerr << "Error: Could not open shard result file: " << filepath << std::endl;
+            return std::nullopt;
+        }
+        std::uint64_t file_size = static_cast<std::uint64_t>(in.tellg());
+        in.seekg(0);
+
+        ShardResult result;
+        char magic[sizeof(RESULT_MAGIC)];
+        std::uint32_t version = 0;
+        std::uint32_t symbol_length = 0;
+        bool ok = in.read(magic, sizeof(magic)) &&
+                  std::equal(magic, magic + sizeof(magic), RESULT_MAGIC) &&
+                  read_value(in, version) && version == RESULT_VERSION &&
+                  read_value(in, result.spec.index) &&
+                  read_value(in, symbol_length) && symbol_length <= remaining(in, file_size);
+        if (ok) {
+            result.spec.symbol.resize(symbol_length);
+            ok = in.read(result.spec.symbol.data(), symbol_length) &&
+                 read_value(in, result.spec.first_timestamp) &&
+                 read_value(in, result.spec.last_timestamp) &&
+                 read_value(in, result.trade_count) &&
+                 read_value(in, result.rows_processed);
+        }
+
+        std::uint64_t count = 0;
+        if (ok && (ok = read_count(in, remaining(in, file_size), sizeof(std::int64_t) + sizeof(double), count))) {
+            result.pnl.resize(count);
+            for (PnlPoint& point : result.pnl) {
+                ok = ok && read_value(in, point.timestamp) && read_value(in, point.pnl);
+            }
+        }
+        if (ok && (ok = read_count(in, remaining(in, file_size), sizeof(std::uint64_t) + 2 * sizeof(double), count))) {
+            result.contracts.resize(count);
+            for (ContractActivity& contract : result.contracts) {
+                ok = ok && read_value(in, contract.contract_id) &&
+                     read_value(in, contract.quantity_change) && read_value(in, contract.last_mark);
+            }
+        }
+
+        if (!ok) {
+            std::cerr << "Error: Invalid or truncated shard result file: " << filepath << std::endl;
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    bool run_shard(const ShardWorker& worker, const ShardSpec& spec, const std::string& output_path) {
+        ShardResult result;
+        result.spec = spec;
+        if (!worker(spec, result)) {
+            std::cerr << "Error: Worker failed for shard " << spec.index << " (" << spec.symbol << ")." << std::endl;
+            return false;
+        }
+        result.spec = spec; // Workers may not rewrite the shard they were given
+        return write_shard_result(output_path, result);
+    }
+
+    bool run_local_shards(const std::vector<ShardSpec>& shards, const ShardWorker& worker,
+                          const std::string& output_directory, unsigned max_workers) {
+        if (max_workers == 0) {
+            max_workers = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // Flush buffered output so children do not inherit and re-emit it.
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(nullptr);
+
+        bool all_ok = true;
+        std::vector<pid_t> workers; // Only our own children are waited for, never other children of the caller
+        auto reap_one = [&]() {
+            while (true) {
+                for (std::size_t i = 0; i < workers.size(); ++i) {
+                    const pid_t worker_pid = workers[i];
+                    int status = 0;
+                    pid_t pid = waitpid(worker_pid, &status, WNOHANG);
+                    if (pid == 0 || (pid < 0 && errno == EINTR)) continue; // Still running
+                    workers.erase(workers.begin() + static_cast<std::ptrdiff_t>(i));
+                    if (pid < 0) {
+                        std::cerr << "Error: waitpid failed for shard worker process " << worker_pid << "." << std::endl;
+                        all_ok = false;
+                    } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                        std::cerr << "Error: Shard worker process " << worker_pid << " failed." << std::endl;
+                        all_ok = false;
+                    }
+                    return;
+                }
+                // Shards run for far longer than this, so polling costs nothing measurable
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        };
+
+        for (const ShardSpec& spec : shards) {
+            if (workers.size() >= max_workers) {
+                reap_one();
+            }
+
+            pid_t pid = fork();
+            if (pid < 0) {
+                std::cerr << "Error: Could not fork worker for shard " << spec.index << "." << std::endl;
+                all_ok = false;
+                break;
+            }
+            if (pid == 0) {
+                // Child: run the shard and leave without running the parent's atexit handlers.
+                bool ok = run_shard(worker, spec, shard_result_path(output_directory, spec));
+                std::cout.flush();
+                std::cerr.flush();
+                _exit(ok ? 0 : 1);
+            }
+            workers.push_back(pid);
+        }
+
+        while (!workers.empty()) {
+            reap_one();
+        }
+        return all_ok;
+    }
+
+    std::optional<MergedResult> merge_shard_results(std::vector<ShardResult> results) {
+        std::set<std::uint32_t> seen_indices;
+        for (const ShardResult& result : results) {
+            if (!seen_indices.insert(result.spec.index).second) {
+                std::cerr << "Error: Duplicate result for shard " << result.spec.index << "." << std::endl;
+                return std::nullopt;
+            }
+        }
+        std::sort(results.begin(), results.end(), shard_before);
+
+        MergedResult merged;
+        merged.shard_count = results.size();
+        std::vector<OrderedPnl> points;
+        std::map<std::uint64_t, CarriedPosition> carried;
+
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const ShardResult& shard = results[i];
+            bool first_of_symbol = (i == 0) || results[i - 1].spec.symbol != shard.spec.symbol;
+            if (first_of_symbol) {
+                carried.clear();
+            }
+
+            for (const PnlPoint& point : shard.pnl) {
+                points.push_back(OrderedPnl{point.timestamp, points.size(), point.pnl});
+            }
+
+            // Positions carried in from earlier shards are marked to this shard's last price
+            // and the whole move is booked at the shard's last timestamp (see shard_runner.h).
+            double carried_pnl = 0.0;
+            for (const ContractActivity& contract : shard.contracts) {
+                CarriedPosition& position = carried[contract.contract_id];
+                carried_pnl += position.quantity * (contract.last_mark - position.last_mark);
+                position.quantity += contract.quantity_change;
+                position.last_mark = contract.last_mark;
+            }
+            if (carried_pnl != 0.0) {
+                points.push_back(OrderedPnl{shard.spec.last_timestamp, points.size(), carried_pnl});
+            }
+
+            merged.trade_count += shard.trade_count;
+            merged.rows_processed += shard.rows_processed;
+
+            bool last_of_symbol = (i + 1 == results.size()) || results[i + 1].spec.symbol != shard.spec.symbol;
+            if (last_of_symbol) {
+                for (const auto& [contract_id, position] : carried) {
+                    if (position.quantity != 0.0) {
+                        merged.positions.push_back(MergedPosition{shard.spec.symbol, contract_id,
+                                                                  position.quantity, position.last_mark});
+                    }
+                }
+            }
+        }
+
+        std::sort(points.begin(), points.end(), [](const OrderedPnl& a, const OrderedPnl& b) {
+            return a.timestamp != b.timestamp ? a.timestamp < b.timestamp : a.order < b.order;
+        });
+
+        for (const OrderedPnl& point : points) {
+            if (merged.pnl.empty() || merged.pnl.back().timestamp != point.timestamp) {
+                merged.pnl.push_back(PnlPoint{point.timestamp, 0.0});
+            }
+            merged.pnl.back().pnl += point.pnl;
+        }
+
+        double cumulative = 0.0;
+        double peak = 0.0;
+        for (const PnlPoint& point : merged.pnl) {
+            cumulative += point.pnl;
+            peak = std::max(peak, cumulative);
+            merged.max_drawdown = std::max(merged.max_drawdown, peak - cumulative);
+        }
+        merged.total_pnl = cumulative;
+        return merged;
+    }
+
+    std::optional<MergedResult> merge_shard_files(const std::vector<ShardSpec>& shards,
+                                                  const std::string& directory) {
+        std::vector<ShardResult> results;
+        results.reserve(shards.size());
+        for (const ShardSpec& spec : shards) {
+            std::optional<ShardResult> result = read_shard_result(shard_result_path(directory, spec));
+            if (!result.has_value()) {
+                return std::nullopt;
+            }
+            results.push_back(std::move(result.value()));
+        }
+        return merge_shard_results(std::move(results));
+    }
+
+} // namespace backtest
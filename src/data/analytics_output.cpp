@@ -0,0 +1,348 @@
+#include "data/analytics_output.h"
+#include <cstring>      // For std::memcpy
+#include <iostream>     // For error messages
+#include <type_traits>  // For std::is_trivially_copyable_v
+
+#include <fcntl.h>      // For ::open
+#include <sys/mman.h>   // For mmap, munmap
+#include <sys/stat.h>   // For fstat
+#include <unistd.h>     // For ::close
+
+namespace analytics_output {
+
+    namespace {
+
+        // File layout:
+        //   header: u32 magic, u32 version, u32 block_rows, u32 column count
+        //   blocks: u64 rows, then the COLUMN_COUNT columns in AnalyticsRow
+        //           order, each zero-padded to a multiple of 8 bytes
+        //   index:  BlockIndexEntry per block, u64 block count, u32 magic, u32 padding
+        constexpr std::uint32_t FILE_MAGIC = 0x4E415456;   // "VTAN" in little-endian byte order
+        constexpr std::uint32_t INDEX_MAGIC = 0x58444956;  // "VIDX" in little-endian byte order
+        constexpr std::uint32_t FILE_VERSION = 1;
+        constexpr std::uint32_t COLUMN_COUNT = 13;
+        constexpr std::uint32_t BYTE_COLUMNS = 2;          // type and signal
+        constexpr std::size_t HEADER_SIZE = 4 * sizeof(std::uint32_t);
+        constexpr std::size_t TRAILER_SIZE = sizeof(std::uint64_t) + 2 * sizeof(std::uint32_t);
+
+        std::uint64_t padded(std::uint64_t bytes) {
+            return (bytes + 7) & ~std::uint64_t{7};
+        }
+
+        std::uint64_t block_bytes(std::uint64_t rows) {
+            return sizeof(std::uint64_t) + (COLUMN_COUNT - BYTE_COLUMNS) * rows * 8 + BYTE_COLUMNS * padded(rows);
+        }
+
+        template <typename T>
+        void write_value(std::ofstream& out, const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template <typename T>
+        void write_column(std::ofstream& out, const std::vector<T>& column) {
+            static constexpr char ZEROS[8] = {};
+            std::size_t bytes = column.size() * sizeof(T);
+            out.write(reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(bytes));
+            out.write(ZEROS, static_cast<std::streamsize>(padded(bytes) - bytes));
+        }
+
+        template <typename T>
+        T read_value(const char* data) {
+            T value;
+            std::memcpy(&value, data, sizeof(T));
+            return value;
+        }
+
+        // Span over the next column of a block and advances `cursor` past its padding.
+        template <typename T>
+        std::span<const T> take_column(const char*& cursor, std::size_t rows) {
+            std::span<const T> column(reinterpret_cast<const T*>(cursor), rows);
+            cursor += padded(rows * sizeof(T));
+            return column;
+        }
+
+    } // namespace
+
+    // --- AnalyticsWriter ---
+
+    void AnalyticsWriter::ColumnBlock::reserve(std::size_t rows) {
+        timestamp.reserve(rows);
+        strike_price.reserve(rows);
+        time_to_expiration.reserve(rows);
+        type.reserve(rows);
+        market_price.reserve(rows);
+        implied_vol.reserve(rows);
+        realized_vol.reserve(rows);
+        discrepancy.reserve(rows);
+        signal.reserve(rows);
+        delta.reserve(rows);
+        vega.reserve(rows);
+        theta.reserve(rows);
+        rho.reserve(rows);
+    }
+
+    void AnalyticsWriter::ColumnBlock::clear() {
+        timestamp.clear();
+        strike_price.clear();
+        time_to_expiration.clear();
+        type.clear();
+        market_price.clear();
+        implied_vol.clear();
+        realized_vol.clear();
+        discrepancy.clear();
+        signal.clear();
+        delta.clear();
+        vega.clear();
+        theta.clear();
+        rho.clear();
+    }
+
+    AnalyticsWriter::AnalyticsWriter(std::uint32_t block_rows)
+        : block_rows_(block_rows > 0 ? block_rows : DEFAULT_BLOCK_ROWS) {}
+
+    AnalyticsWriter::~AnalyticsWriter() {
+        if (is_open_) {
+            close();
+        }
+    }
+
+    bool AnalyticsWriter::open(const std::string& filepath) {
+        if (is_open_) {
+            close();
+        }
+
+        file_.open(filepath, std::ios::binary | std::ios::trunc);
+        if (!file_.is_open()) {
+            std::cerr << "Error: Could not create analytics file: " << filepath << std::endl;
+            return false;
+        }
+
+        write_value(file_, FILE_MAGIC);
+        write_value(file_, FILE_VERSION);
+        write_value(file_, block_rows_);
+        write_value(file_, COLUMN_COUNT);
+        file_offset_ = HEADER_SIZE;
+
+        filling_.clear();
+        writing_.clear();
+        filling_.reserve(block_rows_);
+        writing_.reserve(block_rows_);
+        index_.clear();
+        row_count_ = 0;
+        block_pending_ = false;
+        stopping_ = false;
+        failed_ = false;
+        is_open_ = true;
+        thread_ = std::thread(&AnalyticsWriter::run, this);
+        return true;
+    }
+
+    bool AnalyticsWriter::append(const AnalyticsRow& row) {
+        if (!is_open_) {
+            return false;
+        }
+
+        filling_.timestamp.push_back(row.timestamp);
+        filling_.strike_price.push_back(row.strike_price);
+        filling_.time_to_expiration.push_back(row.time_to_expiration);
+        filling_.type.push_back(static_cast<char>(row.type));
+        filling_.market_price.push_back(row.market_price);
+        filling_.implied_vol.push_back(row.implied_vol);
+        filling_.realized_vol.push_back(row.realized_vol);
+        filling_.discrepancy.push_back(row.discrepancy);
+        filling_.signal.push_back(static_cast<char>(row.signal));
+        filling_.delta.push_back(row.delta);
+        filling_.vega.push_back(row.vega);
+        filling_.theta.push_back(row.theta);
+        filling_.rho.push_back(row.rho);
+        ++row_count_;
+
+        if (filling_.size() == block_rows_) {
+            hand_off();
+        }
+        return true;
+    }
+
+    void AnalyticsWriter::hand_off() {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            block_written_.wait(lock, [this] { return !block_pending_; });
+            std::swap(filling_, writing_); // Both keep their capacity, so no allocation after the first two blocks
+            block_pending_ = true;
+        }
+        block_ready_.notify_one();
+        filling_.clear();
+    }
+
+    void AnalyticsWriter::run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            block_ready_.wait(lock, [this] { return block_pending_ || stopping_; });
+            if (!block_pending_) break; // Stopping with nothing left to write
+
+            lock.unlock();
+            write_block(writing_);
+            lock.lock();
+
+            block_pending_ = false;
+            block_written_.notify_one();
+        }
+    }
+
+    void AnalyticsWriter::write_block(const ColumnBlock& block) {
+        std::uint64_t rows = block.size();
+        index_.push_back(BlockIndexEntry{file_offset_, rows});
+
+        write_value(file_, rows);
+        write_column(file_, block.timestamp);
+        write_column(file_, block.strike_price);
+        write_column(file_, block.time_to_expiration);
+        write_column(file_, block.type);
+        write_column(file_, block.market_price);
+        write_column(file_, block.implied_vol);
+        write_column(file_, block.realized_vol);
+        write_column(file_, block.discrepancy);
+        write_column(file_, block.signal);
+        write_column(file_, block.delta);
+        write_column(file_, block.vega);
+        write_column(file_, block.theta);
+        write_column(file_, block.rho);
+        file_offset_ += block_bytes(rows);
+
+        if (!file_.good()) {
+            failed_ = true;
+        }
+    }
+
+    bool AnalyticsWriter::close() {
+        if (!is_open_) {
+            return false;
+        }
+
+        if (filling_.size() > 0) {
+            hand_off();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        block_ready_.notify_one();
+        thread_.join();
+
+        // The background thread has stopped, so index_ and file_ are ours again
+        for (const BlockIndexEntry& entry : index_) {
+            write_value(file_, entry.offset);
+            write_value(file_, entry.row_count);
+        }
+        write_value(file_, static_cast<std::uint64_t>(index_.size()));
+        write_value(file_, INDEX_MAGIC);
+        write_value(file_, std::uint32_t{0});
+        file_.flush();
+
+        bool ok = file_.good() && !failed_;
+        if (!ok) {
+            std::cerr << "Error: Failed to write analytics file." << std::endl;
+        }
+        file_.close();
+        is_open_ = false;
+        return ok;
+    }
+
+    // --- AnalyticsReader ---
+
+    AnalyticsReader::~AnalyticsReader() {
+        close();
+    }
+
+    bool AnalyticsReader::open(const std::string& filepath) {
+        close();
+
+        int fd = ::open(filepath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error: Could not open analytics file: " << filepath << std::endl;
+            return false;
+        }
+        struct stat info {};
+        if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(HEADER_SIZE + TRAILER_SIZE)) {
+            std::cerr << "Error: Analytics file is too short: " << filepath << std::endl;
+            ::close(fd);
+            return false;
+        }
+        size_ = static_cast<std::size_t>(info.st_size);
+        void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // The mapping stays valid after the descriptor is closed
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Error: Could not map analytics file: " << filepath << std::endl;
+            size_ = 0;
+            return false;
+        }
+        data_ = static_cast<const char*>(mapping);
+
+        bool ok = read_value<std::uint32_t>(data_) == FILE_MAGIC &&
+                  read_value<std::uint32_t>(data_ + 4) == FILE_VERSION &&
+                  read_value<std::uint32_t>(data_ + 12) == COLUMN_COUNT &&
+                  read_value<std::uint32_t>(data_ + size_ - 8) == INDEX_MAGIC;
+
+        std::uint64_t block_count = ok ? read_value<std::uint64_t>(data_ + size_ - TRAILER_SIZE) : 0;
+        std::uint64_t index_bytes = block_count * sizeof(BlockIndexEntry);
+        ok = ok && block_count <= (size_ - HEADER_SIZE - TRAILER_SIZE) / sizeof(BlockIndexEntry);
+
+        if (ok) {
+            const char* entry = data_ + size_ - TRAILER_SIZE - index_bytes;
+            std::uint64_t blocks_end = size_ - TRAILER_SIZE - index_bytes;
+            index_.resize(block_count);
+            for (BlockIndexEntry& block : index_) {
+                block.offset = read_value<std::uint64_t>(entry);
+                block.row_count = read_value<std::uint64_t>(entry + 8);
+                entry += sizeof(BlockIndexEntry);
+                // Blocks must lie inside the data area, be 8-byte aligned and hold the rows they claim
+                ok = ok && block.offset >= HEADER_SIZE && block.offset % 8 == 0 && block.offset < blocks_end &&
+                     block.row_count <= (blocks_end - block.offset) / (8 * (COLUMN_COUNT - BYTE_COLUMNS)) &&
+                     block_bytes(block.row_count) <= blocks_end - block.offset &&
+                     read_value<std::uint64_t>(data_ + block.offset) == block.row_count;
+                row_count_ += block.row_count;
+            }
+        }
+
+        if (!ok) {
+            std::cerr << "Error: Invalid or truncated analytics file: " << filepath << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void AnalyticsReader::close() {
+        if (data_ != nullptr) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+        index_.clear();
+        row_count_ = 0;
+    }
+
+    AnalyticsBlock AnalyticsReader::block(std::size_t i) const {
+        const BlockIndexEntry& entry = index_.at(i);
+        std::size_t rows = static_cast<std::size_t>(entry.row_count);
+        const char* cursor = data_ + entry.offset + sizeof(std::uint64_t);
+
+        AnalyticsBlock block;
+        block.timestamp = take_column<std::int64_t>(cursor, rows);
+        block.strike_price = take_column<double>(cursor, rows);
+        block.time_to_expiration = take_column<double>(cursor, rows);
+        block.type = take_column<char>(cursor, rows);
+        block.market_price = take_column<double>(cursor, rows);
+        block.implied_vol = take_column<double>(cursor, rows);
+        block.realized_vol = take_column<double>(cursor, rows);
+        block.discrepancy = take_column<double>(cursor, rows);
+        block.signal = take_column<char>(cursor, rows);
+        block.delta = take_column<double>(cursor, rows);
+        block.vega = take_column<double>(cursor, rows);
+        block.theta = take_column<double>(cursor, rows);
+        block.rho = take_column<double>(cursor, rows);
+        return block;
+    }
+
+} // namespace analytics_output
@@ -3,6 +3,7 @@
 #include <sstream>      // For string stream operations
 #include <iostream>     // For error messages
 #include <limits>       // For numeric_limits (used in error handling)
+#include <algorithm>    // For std::min, std::max
 
 namespace data_loader {
 
@@ -56,36 +57,108 @@ namespace data_loader {
         return std::nullopt;
     }
 
-    std::vector<double> load_historical_prices_from_csv(const std::string& filepath) {
-        std::vector<double> prices;
-        std::ifstream file(filepath);
-        if (!file.is_open()) {
-            std::cerr << "Error: Could not open historical prices file: " << filepath << std::endl;
-            return prices; // Return empty vector
-        }
+    namespace {
 
-        std::string line;
-        // Read header line (e.g., "price")
-        std::getline(file, line);
-        if (file.eof() && line.empty()) {
-            std::cerr << "Warning: Historical prices file is empty after header: " << filepath << std::endl;
+        // Reads prices from `offset` (0 = start of file, header skipped) and moves
+        // `offset` past every line consumed. With complete_lines_only, a last line
+        // without a trailing newline is left unread: the file may still be being written.
+        std::vector<double> read_prices(const std::string& filepath, std::uint64_t& offset, bool complete_lines_only,
+                                        std::size_t max_prices) {
+            std::vector<double> prices;
+            std::ifstream file(filepath, std::ios::ate);
+            if (!file.is_open()) {
+                std::cerr << "Error: Could not open historical prices file: " << filepath << std::endl;
+                return prices; // Return empty vector
+            }
+            const std::uint64_t file_size = static_cast<std::uint64_t>(file.tellg());
+            if (offset > file_size) {
+                std::cerr << "Error: Offset " << offset << " is past the end of historical prices file: " << filepath << std::endl;
+                return prices;
+            }
+            file.seekg(static_cast<std::streamoff>(offset));
+
+            std::string line;
+            if (offset == 0) {
+                // Read header line (e.g., "price")
+                std::getline(file, line);
+                if (file.eof() && (line.empty() || complete_lines_only)) {
+                    if (line.empty()) {
+                        std::cerr << "Warning: Historical prices file is empty after header: " << filepath << std::endl;
+                    }
+                    return prices;
+                }
+                offset = static_cast<std::uint64_t>(file.tellg());
+            }
+
+            while (prices.size() < max_prices && std::getline(file, line)) {
+                // getline only hits end of file on a line without a trailing newline
+                bool terminated = !file.eof();
+                if (!terminated && complete_lines_only) {
+                    break; // Partial line; read it next time, once it is complete
+                }
+                offset = terminated ? static_cast<std::uint64_t>(file.tellg()) : file_size;
+
+                std::stringstream ss(line);
+                std::string segment;
+                if (std::getline(ss, segment)) { // Only one column expected
+                    try {
+                        prices.push_back(std::stod(segment));
+                    } catch (const std::invalid_argument& e) {
+                        std::cerr << "Warning: Skipping invalid price value '" << segment << "' in " << filepath << ": " << e.what() << std::endl;
+                    } catch (const std::out_of_range& e) {
+                        std::cerr << "Warning: Skipping out-of-range price value '" << segment << "' in " << filepath << ": " << e.what() << std::endl;
+                    }
+                }
+            }
             return prices;
         }
 
-        while (std::getline(file, line)) {
-            std::stringstream ss(line);
-            std::string segment;
-            if (std::getline(ss, segment)) { // Only one column expected
-                try {
-                    prices.push_back(std::stod(segment));
-                } catch (const std::invalid_argument& e) {
-                    std::cerr << "Warning: Skipping invalid price value '" << segment << "' in " << filepath << ": " << e.what() << std::endl;
-                } catch (const std::out_of_range& e) {
-                    std::cerr << "Warning: Skipping out-of-range price value '" << segment << "' in " << filepath << ": " << e.what() << std::endl;
-                }
+        constexpr std::uint64_t FINGERPRINT_WINDOW = 4096;
+
+        void hash_bytes(std::uint64_t& hash, const char* data, std::size_t size) {
+            for (std::size_t i = 0; i < size; ++i) { // FNV-1a
+                hash ^= static_cast<unsigned char>(data[i]);
+                hash *= 0x100000001b3ull;
             }
         }
-        return prices;
+
+    } // namespace
+
+    std::vector<double> load_historical_prices_from_csv(const std::string& filepath) {
+        std::uint64_t offset = 0;
+        return read_prices(filepath, offset, false, SIZE_MAX);
+    }
+
+    std::vector<double> load_historical_prices_from_csv(const std::string& filepath, std::uint64_t& offset,
+                                                        std::size_t max_prices) {
+        return read_prices(filepath, offset, true, max_prices);
+    }
+
+    std::optional<std::uint64_t> fingerprint_file_prefix(const std::string& filepath, std::uint64_t length) {
+        std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+        if (!file.is_open() || static_cast<std::uint64_t>(file.tellg()) < length) {
+            return std::nullopt;
+        }
+
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+        hash_bytes(hash, reinterpret_cast<const char*>(&length), sizeof(length));
+
+        // Start of the file (header and first prices) and the bytes just before `length`
+        std::uint64_t head = std::min(length, FINGERPRINT_WINDOW);
+        std::uint64_t tail_start = std::max(head, length > FINGERPRINT_WINDOW ? length - FINGERPRINT_WINDOW : 0);
+        std::string buffer(static_cast<std::size_t>(head), '\0');
+        file.seekg(0);
+        file.read(buffer.data(), static_cast<std::streamsize>(head));
+        hash_bytes(hash, buffer.data(), buffer.size());
+        buffer.assign(static_cast<std::size_t>(length - tail_start), '\0');
+        file.seekg(static_cast<std::streamoff>(tail_start));
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hash_bytes(hash, buffer.data(), buffer.size());
+
+        if (!file) {
+            return std::nullopt;
+        }
+        return hash;
     }
 
     std::vector<OptionData> load_option_data_from_csv(const std::string& filepath) {
@@ -124,7 +197,7 @@ namespace data_loader {
                 // type
                 if (valid_line && std::getline(ss, segment, ',')) {
                     if (segment.length() == 1 && (segment[0] == 'C' || segment[0] == 'P')) {
-                        data.type = segment[0];
+                        data.type = static_cast<OptionType>(segment[0]);
                     } else {
                         valid_line = false;
                         std::cerr << "Warning: Invalid option type '" << segment << "' in " << filepath << std::endl;
@@ -150,4 +223,48 @@ namespace data_loader {
         return options;
     }
 
+    std::optional<TermStructure> load_term_structure_from_csv(const std::string& filepath) {
+        std::ifstream file(filepath);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open term structure file: " << filepath << std::endl;
+            return std::nullopt;
+        }
+
+        std::string line;
+        // Read header line (e.g., "tenor,rate")
+        std::getline(file, line);
+
+        std::vector<double> tenors;
+        std::vector<double> rates;
+        while (std::getline(file, line)) {
+            std::stringstream ss(line);
+            std::string tenor_segment, rate_segment;
+            if (!std::getline(ss, tenor_segment, ',') || !std::getline(ss, rate_segment)) {
+                std::cerr << "Warning: Skipping malformed term structure line: " << line << std::endl;
+                continue;
+            }
+            try {
+                double tenor = std::stod(tenor_segment);
+                double rate = std::stod(rate_segment);
+                tenors.push_back(tenor);
+                rates.push_back(rate);
+            } catch (const std::invalid_argument& e) {
+                std::cerr << "Warning: Skipping term structure line (invalid argument): '" << line << "': " << e.what() << std::endl;
+            } catch (const std::out_of_range& e) {
+                std::cerr << "Warning: Skipping term structure line (out of range): '" << line << "': " << e.what() << std::endl;
+            }
+        }
+
+        if (tenors.empty()) {
+            std::cerr << "Error: No points found in term structure file: " << filepath << std::endl;
+            return std::nullopt;
+        }
+        try {
+            return TermStructure(std::move(tenors), std::move(rates));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid term structure in " << filepath << ": " << e.what() << std::endl;
+            return std::nullopt;
+        }
+    }
+
 } // namespace data_loader
@@ -0,0 +1,62 @@
+#include "data/expiry_factors.h"
+#include <algorithm> // For std::sort, std::unique, std::lower_bound
+#include <cmath>     // For std::exp, std::sqrt
+
+ExpiryFactors make_expiry_factors(double spot_price, const TermStructure& rates,
+                                  const TermStructure& dividends, double time_to_expiration) {
+    ExpiryFactors factors;
+    factors.time_to_expiration = time_to_expiration;
+    if (time_to_expiration > 0.0) {
+        factors.rate = rates.rate(time_to_expiration);
+        factors.dividend_yield = dividends.rate(time_to_expiration);
+        factors.discount_factor = std::exp(-factors.rate * time_to_expiration);
+        factors.dividend_factor = std::exp(-factors.dividend_yield * time_to_expiration);
+        factors.sqrt_time = std::sqrt(time_to_expiration);
+    }
+    factors.forward = spot_price * factors.dividend_factor / factors.discount_factor;
+    return factors;
+}
+
+ExpiryFactors make_expiry_factors(const MarketData& market, double time_to_expiration) {
+    return make_expiry_factors(market.spot_price, TermStructure(market.risk_free_rate),
+                               TermStructure(market.dividend_yield), time_to_expiration);
+}
+
+namespace {
+
+    // Collects the distinct expiries of `chain` into `times` and maps every contract to one.
+    void group_expiries(const std::vector<OptionData>& chain, std::vector<double>& times,
+                        std::vector<std::size_t>& contract_expiry) {
+        times.clear();
+        for (const OptionData& option : chain) times.push_back(option.time_to_expiration);
+        std::sort(times.begin(), times.end());
+        times.erase(std::unique(times.begin(), times.end()), times.end());
+
+        contract_expiry.clear();
+        for (const OptionData& option : chain) {
+            auto it = std::lower_bound(times.begin(), times.end(), option.time_to_expiration);
+            contract_expiry.push_back(static_cast<std::size_t>(it - times.begin()));
+        }
+    }
+
+} // namespace
+
+void ExpiryFactorCache::build(double spot_price, const TermStructure& rates, const TermStructure& dividends,
+                              const std::vector<OptionData>& chain) {
+    group_expiries(chain, times_, contract_expiry_);
+    expiries_.clear();
+    for (double time : times_) {
+        expiries_.push_back(make_expiry_factors(spot_price, rates, dividends, time));
+    }
+}
+
+void ExpiryFactorCache::build(const MarketData& market, const std::vector<OptionData>& chain) {
+    build(market.spot_price, TermStructure(market.risk_free_rate), TermStructure(market.dividend_yield), chain);
+}
+
+const ExpiryFactors* ExpiryFactorCache::find(double time_to_expiration) const {
+    auto it = std::lower_bound(expiries_.begin(), expiries_.end(), time_to_expiration,
+                               [](const ExpiryFactors& f, double t) { return f.time_to_expiration < t; });
+    if (it == expiries_.end() || it->time_to_expiration != time_to_expiration) return nullptr;
+    return &*it;
+}
@@ -0,0 +1,39 @@
+#include "data/term_structure.h"
+#include <algorithm> // For std::upper_bound
+#include <cmath>     // For std::exp
+#include <string>    // For std::to_string
+
+TermStructure::TermStructure(double flat_rate)
+    : tenors_{1.0}, rates_{flat_rate} {}
+
+TermStructure::TermStructure(std::vector<double> tenors, std::vector<double> rates)
+    : tenors_(std::move(tenors)), rates_(std::move(rates)) {
+    if (tenors_.empty() || tenors_.size() != rates_.size()) {
+        throw std::invalid_argument("Term structure needs the same, non-zero number of tenors and rates (got " +
+                                    std::to_string(tenors_.size()) + " tenors, " + std::to_string(rates_.size()) + " rates).");
+    }
+    for (std::size_t i = 0; i < tenors_.size(); ++i) {
+        if (tenors_[i] <= 0.0 || (i > 0 && tenors_[i] <= tenors_[i - 1])) {
+            throw std::invalid_argument("Term structure tenors must be positive and strictly increasing (tenor " +
+                                        std::to_string(tenors_[i]) + " at position " + std::to_string(i) + ").");
+        }
+    }
+}
+
+double TermStructure::rate(double time) const {
+    if (tenors_.empty()) return 0.0;
+    if (time <= tenors_.front()) return rates_.front();
+    if (time >= tenors_.back()) return rates_.back();
+
+    // First tenor strictly after `time`; the previous one is at or before it.
+    auto upper = std::upper_bound(tenors_.begin(), tenors_.end(), time);
+    std::size_t i = static_cast<std::size_t>(upper - tenors_.begin());
+    double t0 = tenors_[i - 1], t1 = tenors_[i];
+    double weight = (time - t0) / (t1 - t0);
+    double integrated = (1.0 - weight) * rates_[i - 1] * t0 + weight * rates_[i] * t1;
+    return integrated / time;
+}
+
+double TermStructure::discount_factor(double time) const {
+    return std::exp(-rate(time) * time);
+}
@@ -0,0 +1,641 @@
+#include "data/tick_archive.h"
+#include <algorithm>    // For std::lower_bound, std::upper_bound
+#include <bit>          // For std::bit_cast, std::countl_zero, std::countr_zero
+#include <cmath>        // For std::round, std::abs, std::signbit
+#include <iostream>     // For error messages
+
+namespace tick_archive {
+
+    namespace {
+
+        constexpr std::uint32_t FILE_MAGIC = 0x52415456;   // "VTAR" in little-endian byte order
+        constexpr std::uint32_t INDEX_MAGIC = 0x58495456;  // "VTIX" in little-endian byte order
+        constexpr std::uint32_t FORMAT_VERSION = 1;
+        constexpr std::size_t HEADER_SIZE = 12;       // magic + version + block_rows
+        constexpr std::size_t INDEX_ENTRY_SIZE = 32;  // offset + size + rows + first + last
+        constexpr std::size_t FOOTER_SIZE = 12;       // entry count + magic
+        constexpr int MAX_DECIMAL_PLACES = 6;
+        constexpr double DECIMAL_SCALES[MAX_DECIMAL_PLACES + 1] = {1.0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6};
+
+        // --- Little-endian fixed-width helpers ---
+
+        void put_fixed(std::vector<std::uint8_t>& out, std::uint64_t value, int bytes) {
+            for (int i = 0; i < bytes; ++i) {
+                out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+            }
+        }
+
+        std::uint64_t get_fixed(const std::uint8_t* in, int bytes) {
+            std::uint64_t value = 0;
+            for (int i = 0; i < bytes; ++i) {
+                value |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+            }
+            return value;
+        }
+
+        // --- Varint (LEB128) with zigzag mapping for signed values ---
+
+        std::uint64_t zigzag_encode(std::int64_t value) {
+            return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+        }
+
+        std::int64_t zigzag_decode(std::uint64_t value) {
+            return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+        }
+
+        void put_varint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<std::uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<std::uint8_t>(value));
+        }
+
+        bool get_varint(const std::uint8_t*& in, const std::uint8_t* end, std::uint64_t& value) {
+            value = 0;
+            for (int shift = 0; shift < 64 && in < end; shift += 7) {
+                std::uint8_t byte = *in++;
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) return true;
+            }
+            return false; // Truncated or overlong varint
+        }
+
+        // --- MSB-first bit stream used by the XOR float columns ---
+
+        class BitWriter {
+        public:
+            explicit BitWriter(std::vector<std::uint8_t>& out) : out_(out) {}
+
+            void write(std::uint64_t value, int bits) {
+                while (bits > 0) {
+                    int take = std::min(bits, 64 - count_);
+                    std::uint64_t chunk = (value >> (bits - take)) & mask(take);
+                    buffer_ = (take == 64) ? chunk : (buffer_ << take) | chunk;
+                    count_ += take;
+                    bits -= take;
+                    if (count_ == 64) {
+                        for (int shift = 56; shift >= 0; shift -= 8) {
+                            out_.push_back(static_cast<std::uint8_t>(buffer_ >> shift));
+                        }
+                        buffer_ = 0;
+                        count_ = 0;
+                    }
+                }
+            }
+
+            // Pads the last partial byte with zero bits and emits it.
+            void finish() {
+                if (count_ == 0) return;
+                int padded = (count_ + 7) / 8 * 8;
+                std::uint64_t value = buffer_ << (padded - count_);
+                for (int shift = padded - 8; shift >= 0; shift -= 8) {
+                    out_.push_back(static_cast<std::uint8_t>(value >> shift));
+                }
+                buffer_ = 0;
+                count_ = 0;
+            }
+
+        private:
+            static std::uint64_t mask(int bits) {
+                return bits == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << bits) - 1;
+            }
+
+            std::vector<std::uint8_t>& out_;
+            std::uint64_t buffer_{0};
+            int count_{0};
+        };
+
+        class BitReader {
+        public:
+            BitReader(const std::uint8_t* data, std::size_t size) : data_(data), size_(size) {}
+
+            std::uint64_t read(int bits) {
+                if (bits == 0) return 0;
+                if (bits > 32) {
+                    std::uint64_t high = read(bits - 32);
+                    return (high << 32) | read(32);
+                }
+                if (count_ < bits) refill();
+                std::uint64_t value = window_ >> (64 - bits);
+                window_ <<= bits;
+                count_ -= bits;
+                consumed_ += bits;
+                return value;
+            }
+
+            bool overrun() const { return consumed_ > size_ * 8; }
+
+        private:
+            // Tops the window up to at least 57 bits; reads past the end yield zero bits.
+            void refill() {
+                while (count_ <= 56) {
+                    std::uint8_t byte = next_ < size_ ? data_[next_] : 0;
+                    ++next_;
+                    window_ |= static_cast<std::uint64_t>(byte) << (56 - count_);
+                    count_ += 8;
+                }
+            }
+
+            const std::uint8_t* data_;
+            std::size_t size_;
+            std::size_t next_{0};
+            std::uint64_t window_{0}; // Unread bits, left aligned
+            int count_{0};
+            std::size_t consumed_{0};
+        };
+
+        // --- Column encoders ---
+
+        void encode_timestamps(const std::vector<std::int64_t>& values, std::vector<std::uint8_t>& out) {
+            std::int64_t previous = 0;
+            std::int64_t previous_delta = 0;
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                if (i == 0) {
+                    put_varint(out, zigzag_encode(values[0]));
+                } else {
+                    std::int64_t delta = values[i] - previous;
+                    put_varint(out, zigzag_encode(delta - previous_delta));
+                    previous_delta = delta;
+                }
+                previous = values[i];
+            }
+        }
+
+        bool decode_timestamps(const std::uint8_t* in, const std::uint8_t* end, std::int64_t* values, std::size_t rows) {
+            std::int64_t previous = 0;
+            std::int64_t previous_delta = 0;
+            for (std::size_t i = 0; i < rows; ++i) {
+                std::uint64_t raw;
+                if (!get_varint(in, end, raw)) return false;
+                if (i == 0) {
+                    previous = zigzag_decode(raw);
+                } else {
+                    previous_delta += zigzag_decode(raw);
+                    previous += previous_delta;
+                }
+                values[i] = previous;
+            }
+            return true;
+        }
+
+        // Gorilla XOR encoding: identical values cost one bit, values sharing the
+        // previous leading/trailing zero window cost 2 bits plus the meaningful bits.
+        void encode_xor_doubles(const std::vector<double>& values, std::vector<std::uint8_t>& out) {
+            BitWriter writer(out);
+            std::uint64_t previous = 0;
+            int previous_leading = -1;
+            int previous_trailing = 0;
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                std::uint64_t bits = std::bit_cast<std::uint64_t>(values[i]);
+                if (i == 0) {
+                    writer.write(bits, 64);
+                    previous = bits;
+                    continue;
+                }
+                std::uint64_t x = bits ^ previous;
+                previous = bits;
+                if (x == 0) {
+                    writer.write(0, 1);
+                    continue;
+                }
+                int leading = std::min(std::countl_zero(x), 31);
+                int trailing = std::countr_zero(x);
+                if (previous_leading >= 0 && leading >= previous_leading && trailing >= previous_trailing) {
+                    writer.write(0b10, 2);
+                    writer.write(x >> previous_trailing, 64 - previous_leading - previous_trailing);
+                } else {
+                    int meaningful = 64 - leading - trailing;
+                    writer.write(0b11, 2);
+                    writer.write(static_cast<std::uint64_t>(leading), 5);
+                    writer.write(static_cast<std::uint64_t>(meaningful & 63), 6); // 64 is stored as 0
+                    writer.write(x >> trailing, meaningful);
+                    previous_leading = leading;
+                    previous_trailing = trailing;
+                }
+            }
+            writer.finish();
+        }
+
+        bool decode_xor_doubles(const std::uint8_t* in, std::size_t size, double* values, std::size_t rows) {
+            BitReader reader(in, size);
+            std::uint64_t previous = 0;
+            int leading = 0;
+            int trailing = 0;
+            for (std::size_t i = 0; i < rows; ++i) {
+                if (i == 0) {
+                    previous = reader.read(64);
+                } else if (reader.read(1) != 0) {
+                    if (reader.read(1) != 0) {
+                        leading = static_cast<int>(reader.read(5));
+                        int meaningful = static_cast<int>(reader.read(6));
+                        if (meaningful == 0) meaningful = 64;
+                        trailing = 64 - leading - meaningful;
+                        if (trailing < 0) return false;
+                    }
+                    previous ^= reader.read(64 - leading - trailing) << trailing;
+                }
+                values[i] = std::bit_cast<double>(previous);
+            }
+            return !reader.overrun();
+        }
+
+        // Quotes are usually exact decimals (e.g., cents). Returns the smallest number of
+        // decimal places that round-trips every value, or -1 if there is none.
+        int find_decimal_places(const std::vector<double>& values) {
+            for (int places = 0; places <= MAX_DECIMAL_PLACES; ++places) {
+                double scale = DECIMAL_SCALES[places];
+                bool exact = true;
+                for (double value : values) {
+                    double scaled = std::round(value * scale);
+                    if (!(std::abs(scaled) < 9.0e15) || scaled / scale != value || std::signbit(value)) {
+                        exact = false;
+                        break;
+                    }
+                }
+                if (exact) return places;
+            }
+            return -1;
+        }
+
+        // Double column layout: <u8 encoding><payload>. Encoding 0 is XOR; encoding
+        // n > 0 stores round(value * 10^(n-1)) as zigzag varint deltas. The writer
+        // keeps whichever is smaller for the block.
+        void encode_doubles(const std::vector<double>& values, std::vector<std::uint8_t>& out) {
+            std::size_t start = out.size();
+            out.push_back(0);
+            encode_xor_doubles(values, out);
+
+            int places = find_decimal_places(values);
+            if (places < 0) return;
+
+            std::size_t decimal_start = out.size();
+            out.push_back(static_cast<std::uint8_t>(places + 1));
+            double scale = DECIMAL_SCALES[places];
+            std::int64_t previous = 0;
+            for (double value : values) {
+                std::int64_t scaled = static_cast<std::int64_t>(std::round(value * scale));
+                put_varint(out, zigzag_encode(scaled - previous));
+                previous = scaled;
+            }
+
+            if (out.size() - decimal_start < decimal_start - start) {
+                std::move(out.begin() + decimal_start, out.end(), out.begin() + start);
+                out.resize(start + (out.size() - decimal_start));
+            } else {
+                out.resize(decimal_start);
+            }
+        }
+
+        bool decode_doubles(const std::uint8_t* in, std::size_t size, double* values, std::size_t rows) {
+            if (size == 0) return false;
+            int encoding = in[0];
+            if (encoding == 0) return decode_xor_doubles(in + 1, size - 1, values, rows);
+            if (encoding - 1 > MAX_DECIMAL_PLACES) return false;
+
+            double scale = DECIMAL_SCALES[encoding - 1];
+            const std::uint8_t* cursor = in + 1;
+            const std::uint8_t* end = in + size;
+            std::int64_t previous = 0;
+            for (std::size_t i = 0; i < rows; ++i) {
+                std::uint64_t raw;
+                if (!get_varint(cursor, end, raw)) return false;
+                previous += zigzag_decode(raw);
+                values[i] = static_cast<double>(previous) / scale;
+            }
+            return true;
+        }
+
+        void encode_types(const std::vector<OptionType>& values, std::vector<std::uint8_t>& out) {
+            BitWriter writer(out);
+            for (OptionType type : values) {
+                writer.write(type == OptionType::Put ? 1 : 0, 1);
+            }
+            writer.finish();
+        }
+
+        bool decode_types(const std::uint8_t* in, std::size_t size, OptionType* values, std::size_t rows) {
+            if (size * 8 < rows) return false;
+            BitReader reader(in, size);
+            for (std::size_t i = 0; i < rows; ++i) {
+                values[i] = reader.read(1) != 0 ? OptionType::Put : OptionType::Call;
+            }
+            return true;
+        }
+
+        // Appends a column as <u32 byte length><bytes>.
+        template <typename Encoder>
+        void put_column(std::vector<std::uint8_t>& out, Encoder&& encode) {
+            std::size_t length_at = out.size();
+            put_fixed(out, 0, 4);
+            std::size_t start = out.size();
+            encode(out);
+            std::uint64_t length = out.size() - start;
+            for (int i = 0; i < 4; ++i) {
+                out[length_at + i] = static_cast<std::uint8_t>(length >> (8 * i));
+            }
+        }
+
+        bool get_column(const std::uint8_t*& in, const std::uint8_t* end, const std::uint8_t*& column, std::size_t& length) {
+            if (end - in < 4) return false;
+            length = static_cast<std::size_t>(get_fixed(in, 4));
+            in += 4;
+            if (static_cast<std::size_t>(end - in) < length) return false;
+            column = in;
+            in += length;
+            return true;
+        }
+
+        // Keeps only rows [first, last) of the batch, preserving capacity.
+        void keep_rows(ChainBatch& batch, std::size_t first, std::size_t last) {
+            if (first > 0) {
+                auto shift = [first, last](auto& column) {
+                    std::move(column.begin() + first, column.begin() + last, column.begin());
+                };
+                shift(batch.timestamps);
+                shift(batch.spot_prices);
+                shift(batch.strike_prices);
+                shift(batch.times_to_expiration);
+                shift(batch.types);
+                shift(batch.market_prices);
+            }
+            batch.resize(last - first);
+        }
+
+    } // namespace
+
+    // --- ChainBatch ---
+
+    void ChainBatch::clear() {
+        resize(0);
+    }
+
+    void ChainBatch::resize(std::size_t rows) {
+        timestamps.resize(rows);
+        spot_prices.resize(rows);
+        strike_prices.resize(rows);
+        times_to_expiration.resize(rows);
+        types.resize(rows);
+        market_prices.resize(rows);
+    }
+
+    ChainTick ChainBatch::row(std::size_t i) const {
+        return ChainTick{timestamps[i], spot_prices[i],
+                         OptionData{strike_prices[i], times_to_expiration[i], types[i], market_prices[i]}};
+    }
+
+    // --- TickArchiveWriter ---
+
+    TickArchiveWriter::TickArchiveWriter(std::uint32_t block_rows)
+        : block_rows_(block_rows) {
+        if (block_rows_ == 0) {
+            std::cerr << "Warning: Block size must be positive. Setting to " << DEFAULT_BLOCK_ROWS << "." << std::endl;
+            block_rows_ = DEFAULT_BLOCK_ROWS;
+        }
+    }
+
+    TickArchiveWriter::~TickArchiveWriter() {
+        close();
+    }
+
+    bool TickArchiveWriter::open(const std::string& filepath) {
+        close();
+        file_.open(filepath, std::ios::binary | std::ios::trunc);
+        if (!file_.is_open()) {
+            std::cerr << "Error: Could not create tick archive: " << filepath << std::endl;
+            return false;
+        }
+
+        pending_.clear();
+        index_.clear();
+        encoded_.clear();
+        put_fixed(encoded_, FILE_MAGIC, 4);
+        put_fixed(encoded_, FORMAT_VERSION, 4);
+        put_fixed(encoded_, block_rows_, 4);
+        file_.write(reinterpret_cast<const char*>(encoded_.data()), static_cast<std::streamsize>(encoded_.size()));
+        offset_ = encoded_.size();
+        return file_.good();
+    }
+
+    bool TickArchiveWriter::append(const ChainTick& tick) {
+        if (!file_.is_open()) {
+            std::cerr << "Error: Tick archive is not open." << std::endl;
+            return false;
+        }
+        std::int64_t last_timestamp = !pending_.empty() ? pending_.timestamps.back()
+                                    : !index_.empty()   ? index_.back().last_timestamp
+                                                        : tick.timestamp;
+        if (tick.timestamp < last_timestamp) {
+            std::cerr << "Error: Tick timestamps must be non-decreasing (" << tick.timestamp
+                      << " after " << last_timestamp << ")." << std::endl;
+            return false;
+        }
+
+        // Blocks are only cut between snapshots, so one snapshot never spans two batches.
+        if (pending_.size() >= block_rows_ && tick.timestamp != pending_.timestamps.back()) {
+            if (!flush_block()) return false;
+        }
+
+        pending_.timestamps.push_back(tick.timestamp);
+        pending_.spot_prices.push_back(tick.spot_price);
+        pending_.strike_prices.push_back(tick.option.strike_price);
+        pending_.times_to_expiration.push_back(tick.option.time_to_expiration);
+        pending_.types.push_back(tick.option.type);
+        pending_.market_prices.push_back(tick.option.market_price);
+        return true;
+    }
+
+    bool TickArchiveWriter::flush_block() {
+        if (pending_.empty()) return true;
+
+        encoded_.clear();
+        put_fixed(encoded_, pending_.size(), 4);
+        put_column(encoded_, [this](auto& out) { encode_timestamps(pending_.timestamps, out); });
+        put_column(encoded_, [this](auto& out) { encode_doubles(pending_.spot_prices, out); });
+        put_column(encoded_, [this](auto& out) { encode_doubles(pending_.strike_prices, out); });
+        put_column(encoded_, [this](auto& out) { encode_doubles(pending_.times_to_expiration, out); });
+        put_column(encoded_, [this](auto& out) { encode_types(pending_.types, out); });
+        put_column(encoded_, [this](auto& out) { encode_doubles(pending_.market_prices, out); });
+
+        file_.write(reinterpret_cast<const char*>(encoded_.data()), static_cast<std::streamsize>(encoded_.size()));
+        index_.push_back(BlockIndexEntry{offset_, static_cast<std::uint32_t>(encoded_.size()),
+                                         static_cast<std::uint32_t>(pending_.size()),
+                                         pending_.timestamps.front(), pending_.timestamps.back()});
+        offset_ += encoded_.size();
+        pending_.clear();
+
+        if (!file_.good()) {
+            std::cerr << "Error: Failed to write tick archive block." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool TickArchiveWriter::close() {
+        if (!file_.is_open()) return true;
+
+        bool ok = flush_block();
+
+        encoded_.clear();
+        for (const BlockIndexEntry& entry : index_) {
+            put_fixed(encoded_, entry.offset, 8);
+            put_fixed(encoded_, entry.byte_size, 4);
+            put_fixed(encoded_, entry.row_count, 4);
+            put_fixed(encoded_, static_cast<std::uint64_t>(entry.first_timestamp), 8);
+            put_fixed(encoded_, static_cast<std::uint64_t>(entry.last_timestamp), 8);
+        }
+        put_fixed(encoded_, index_.size(), 8);
+        put_fixed(encoded_, INDEX_MAGIC, 4);
+        file_.write(reinterpret_cast<const char*>(encoded_.data()), static_cast<std::streamsize>(encoded_.size()));
+
+        ok = ok && file_.good();
+        file_.close();
+        if (!ok) {
+            std::cerr << "Error: Failed to finalize tick archive." << std::endl;
+        }
+        return ok;
+    }
+
+    // --- TickArchiveReader ---
+
+    bool TickArchiveReader::open(const std::string& filepath) {
+        file_.close();
+        file_.clear();
+        index_.clear();
+        next_block_ = 0;
+        range_first_ = std::numeric_limits<std::int64_t>::min();
+        range_last_ = std::numeric_limits<std::int64_t>::max();
+
+        file_.open(filepath, std::ios::binary);
+        if (!file_.is_open()) {
+            std::cerr << "Error: Could not open tick archive: " << filepath << std::endl;
+            return false;
+        }
+
+        std::uint8_t header[HEADER_SIZE];
+        if (!file_.read(reinterpret_cast<char*>(header), HEADER_SIZE) ||
+            get_fixed(header, 4) != FILE_MAGIC || get_fixed(header + 4, 4) != FORMAT_VERSION) {
+            std::cerr << "Error: Not a supported tick archive: " << filepath << std::endl;
+            file_.close();
+            return false;
+        }
+
+        file_.seekg(0, std::ios::end);
+        std::uint64_t file_size = static_cast<std::uint64_t>(file_.tellg());
+        std::uint8_t footer[FOOTER_SIZE];
+        if (file_size < HEADER_SIZE + FOOTER_SIZE ||
+            !file_.seekg(static_cast<std::streamoff>(file_size - FOOTER_SIZE)) ||
+            !file_.read(reinterpret_cast<char*>(footer), FOOTER_SIZE) ||
+            get_fixed(footer + 8, 4) != INDEX_MAGIC) {
+            std::cerr << "Error: Tick archive index is missing (was the writer closed?): " << filepath << std::endl;
+            file_.close();
+            return false;
+        }
+
+        std::uint64_t entries = get_fixed(footer, 8);
+        if (entries > (file_size - HEADER_SIZE - FOOTER_SIZE) / INDEX_ENTRY_SIZE) {
+            std::cerr << "Error: Corrupt tick archive index: " << filepath << std::endl;
+            file_.close();
+            return false;
+        }
+
+        std::vector<std::uint8_t> raw(entries * INDEX_ENTRY_SIZE);
+        file_.seekg(static_cast<std::streamoff>(file_size - FOOTER_SIZE - raw.size()));
+        file_.read(reinterpret_cast<char*>(raw.data()), static_cast<std::streamsize>(raw.size()));
+        if (!file_) {
+            std::cerr << "Error: Could not read tick archive index: " << filepath << std::endl;
+            file_.close();
+            return false;
+        }
+
+        index_.reserve(entries);
+        for (std::uint64_t i = 0; i < entries; ++i) {
+            const std::uint8_t* entry = raw.data() + i * INDEX_ENTRY_SIZE;
+            index_.push_back(BlockIndexEntry{get_fixed(entry, 8),
+                                             static_cast<std::uint32_t>(get_fixed(entry + 8, 4)),
+                                             static_cast<std::uint32_t>(get_fixed(entry + 12, 4)),
+                                             static_cast<std::int64_t>(get_fixed(entry + 16, 8)),
+                                             static_cast<std::int64_t>(get_fixed(entry + 24, 8))});
+        }
+        return true;
+    }
+
+    void TickArchiveReader::seek(std::int64_t first_timestamp, std::int64_t last_timestamp) {
+        range_first_ = first_timestamp;
+        range_last_ = last_timestamp;
+        // Blocks are time ordered, so the first candidate is the first block that ends at or after the range start.
+        auto it = std::lower_bound(index_.begin(), index_.end(), first_timestamp,
+                                   [](const BlockIndexEntry& entry, std::int64_t ts) { return entry.last_timestamp < ts; });
+        next_block_ = static_cast<std::size_t>(it - index_.begin());
+    }
+
+    bool TickArchiveReader::next_batch(ChainBatch& batch) {
+        batch.clear();
+        if (!file_.is_open() || next_block_ >= index_.size()) return false;
+
+        const BlockIndexEntry& entry = index_[next_block_];
+        if (entry.first_timestamp > range_last_) {
+            next_block_ = index_.size();
+            return false;
+        }
+        ++next_block_;
+
+        block_buffer_.resize(entry.byte_size);
+        file_.clear();
+        file_.seekg(static_cast<std::streamoff>(entry.offset));
+        file_.read(reinterpret_cast<char*>(block_buffer_.data()), entry.byte_size);
+        if (!file_) {
+            std::cerr << "Error: Could not read tick archive block at offset " << entry.offset << "." << std::endl;
+            return false;
+        }
+
+        const std::uint8_t* in = block_buffer_.data();
+        const std::uint8_t* end = in + block_buffer_.size();
+        std::size_t rows = end - in >= 4 ? static_cast<std::size_t>(get_fixed(in, 4)) : 0;
+        in += 4;
+        if (rows != entry.row_count) {
+            std::cerr << "Error: Corrupt tick archive block at offset " << entry.offset << "." << std::endl;
+            return false;
+        }
+
+        batch.resize(rows);
+        const std::uint8_t* column;
+        std::size_t length;
+        bool ok = get_column(in, end, column, length) &&
+                  decode_timestamps(column, column + length, batch.timestamps.data(), rows) &&
+                  get_column(in, end, column, length) &&
+                  decode_doubles(column, length, batch.spot_prices.data(), rows) &&
+                  get_column(in, end, column, length) &&
+                  decode_doubles(column, length, batch.strike_prices.data(), rows) &&
+                  get_column(in, end, column, length) &&
+                  decode_doubles(column, length, batch.times_to_expiration.data(), rows) &&
+                  get_column(in, end, column, length) &&
+                  decode_types(column, length, batch.types.data(), rows) &&
+                  get_column(in, end, column, length) &&
+                  decode_doubles(column, length, batch.market_prices.data(), rows);
+        if (!ok) {
+            std::cerr << "Error: Corrupt tick archive block at offset " << entry.offset << "." << std::endl;
+            batch.clear();
+            return false;
+        }
+
+        // Only the blocks at the edges of the range need trimming.
+        if (entry.first_timestamp < range_first_ || entry.last_timestamp > range_last_) {
+            auto first = std::lower_bound(batch.timestamps.begin(), batch.timestamps.end(), range_first_);
+            auto last = std::upper_bound(first, batch.timestamps.end(), range_last_);
+            keep_rows(batch, static_cast<std::size_t>(first - batch.timestamps.begin()),
+                      static_cast<std::size_t>(last - batch.timestamps.begin()));
+            if (batch.empty()) return next_batch(batch);
+        }
+        return true;
+    }
+
+    std::uint64_t TickArchiveReader::row_count() const {
+        std::uint64_t rows = 0;
+        for (const BlockIndexEntry& entry : index_) {
+            rows += entry.row_count;
+        }
+        return rows;
+    }
+
+} // namespace tick_archive
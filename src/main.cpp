@@ -1,11 +1,18 @@
+#include <chrono>   // For std::chrono::system_clock, std::chrono::steady_clock
+#include <filesystem> // For std::filesystem::exists
 #include <iostream> // For std::cout, std::endl
+#include <iomanip>  // For std::fixed, std::setprecision
+#include <string>   // For std::string
 #include <vector>   // For std::vector
-#include <span>     // For std::span (C++20)
 
 #include "data/market_data.h"
 #include "data/option_data.h"
 #include "data/data_loader.h"
+#include "data/analytics_output.h"
+#include "data/expiry_factors.h"
+#include "data/term_structure.h"
 #include "strategy/implied_vol_strategy.h"
+#include "strategy/checkpoint.h"
 #include "utils/date_utils.h" // Include our new date utilities
 
 int main() {
@@ -23,15 +30,63 @@ int main() {
               << ", RFR=" << current_market.risk_free_rate * 100 << "%"
               << ", DivYld=" << current_market.dividend_yield * 100 << "%" << std::endl;
 
-    // --- Load Historical Prices (for RV forecasting) ---
-    std::vector<double> historical_prices_vec = data_loader::load_historical_prices_from_csv("../data/historical_prices.csv");
-    if (historical_prices_vec.empty()) {
+    // --- Restore Strategy State ---
+    // Resume from the latest checkpoint so only prices after it are replayed, as long
+    // as the price file is still the one the checkpoint was taken from.
+    const std::string checkpoint_path = "../data/strategy.vtck";
+    const std::string prices_path = "../data/historical_prices.csv";
+    ImpliedVolStrategy strategy;
+    std::uint64_t price_offset = 0;
+    if (std::optional<checkpoint::Checkpoint> saved = checkpoint::read_checkpoint(checkpoint_path)) {
+        if (data_loader::fingerprint_file_prefix(prices_path, saved->source_offset) == saved->source_fingerprint) {
+            strategy.restore(saved->strategy);
+            price_offset = saved->source_offset;
+            std::cout << "Restored checkpoint after " << strategy.events_applied() << " historical prices." << std::endl;
+        } else {
+            std::cerr << "Warning: " << prices_path << " changed since the last checkpoint. Replaying full history." << std::endl;
+        }
+    }
+    checkpoint::CheckpointWriter checkpoint_writer(checkpoint_path);
+
+    // Checkpoint of the current strategy state at the current price offset
+    auto make_checkpoint = [&]() {
+        return checkpoint::Checkpoint{strategy.state(), price_offset,
+                                      data_loader::fingerprint_file_prefix(prices_path, price_offset).value_or(0)};
+    };
+
+    // --- Replay Historical Prices (for RV forecasting) ---
+    // Prices are read in batches so a checkpoint can be taken every
+    // CHECKPOINT_EVERY_EVENTS prices or CHECKPOINT_INTERVAL, whichever comes first;
+    // a crash during a long replay then only loses the prices since the last one.
+    constexpr std::size_t REPLAY_BATCH = 1000;
+    constexpr std::uint64_t CHECKPOINT_EVERY_EVENTS = 100000;
+    constexpr auto CHECKPOINT_INTERVAL = std::chrono::seconds(10);
+    std::size_t replayed = 0;
+    std::uint64_t events_since_checkpoint = 0;
+    auto last_checkpoint = std::chrono::steady_clock::now();
+    while (true) {
+        std::vector<double> batch = data_loader::load_historical_prices_from_csv(prices_path, price_offset, REPLAY_BATCH);
+        if (batch.empty()) break;
+        for (double price : batch) {
+            strategy.on_price(price);
+        }
+        replayed += batch.size();
+        events_since_checkpoint += batch.size();
+        auto now = std::chrono::steady_clock::now();
+        if (events_since_checkpoint >= CHECKPOINT_EVERY_EVENTS || now - last_checkpoint >= CHECKPOINT_INTERVAL) {
+            checkpoint_writer.submit(make_checkpoint());
+            events_since_checkpoint = 0;
+            last_checkpoint = now;
+        }
+    }
+    if (replayed == 0 && strategy.events_applied() == 0) {
         std::cerr << "Failed to load historical prices or file was empty. Exiting." << std::endl;
         return 1;
     }
-    std::span<const double> historical_prices_span = historical_prices_vec;
+    checkpoint_writer.submit(make_checkpoint());
 
-    std::cout << "Loaded " << historical_prices_vec.size() << " historical prices for RV calculation." << std::endl;
+    std::cout << "Loaded " << replayed << " new historical prices for RV calculation ("
+              << strategy.events_applied() << " in total)." << std::endl;
 
     // --- Demonstrate Date Utilities and Option TTM Calculation ---
     std::cout << "\n--- Date Utility Demonstration ---" << std::endl;
@@ -66,15 +121,45 @@ int main() {
 
     std::cout << "\nAnalyzing " << options_to_analyze.size() << " option contracts:" << std::endl;
 
-    // --- Instantiate and Run Strategy ---
-    ImpliedVolStrategy strategy;
+    // --- Rate and Dividend Curves ---
+    // Curves from ../data when present, otherwise flat at the market data rates.
+    auto load_curve = [](const std::string& path, double flat_rate) {
+        std::optional<TermStructure> curve;
+        if (std::filesystem::exists(path)) {
+            curve = data_loader::load_term_structure_from_csv(path);
+        }
+        return curve.value_or(TermStructure(flat_rate));
+    };
+    TermStructure rate_curve = load_curve("../data/rate_curve.csv", current_market.risk_free_rate);
+    TermStructure dividend_curve = load_curve("../data/dividend_curve.csv", current_market.dividend_yield);
+
+    // Discount factors and forwards are computed once per expiry of the chain, not per contract.
+    ExpiryFactorCache expiry_factors;
+    expiry_factors.build(current_market.spot_price, rate_curve, dividend_curve, options_to_analyze);
+
+    // --- Analytics Output ---
+    // Per-contract results are also written to a columnar binary file for research tooling.
+    analytics_output::AnalyticsWriter analytics_writer;
+    if (analytics_writer.open("../data/analytics.vtan")) {
+        strategy.set_analytics_writer(&analytics_writer);
+    }
+    strategy.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
 
-    for (const auto& opt : options_to_analyze) {
+    // --- Run Strategy ---
+    for (std::size_t i = 0; i < options_to_analyze.size(); ++i) {
+        const OptionData& opt = options_to_analyze[i];
         std::cout << "\nAnalyzing Option: Strike=" << opt.strike_price
                   << ", TTM=" << opt.time_to_expiration
-                  << "y, Type=" << opt.type
+                  << "y, Type=" << to_string(opt.type)
                   << ", Market Price=" << opt.market_price << std::endl;
-        strategy.analyze(opt, current_market, historical_prices_span);
+        strategy.analyze(option_contract_id(opt), opt, expiry_factors.for_contract(i));
+    }
+    checkpoint_writer.submit(make_checkpoint());
+
+    strategy.set_analytics_writer(nullptr);
+    if (analytics_writer.is_open() && analytics_writer.close()) {
+        std::cout << "\nWrote " << analytics_writer.row_count() << " analytics rows to ../data/analytics.vtan" << std::endl;
     }
 
     std::cout << "\n--- Simulation Complete ---" << std::endl;
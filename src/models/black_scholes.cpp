@@ -1,43 +1,83 @@
 #include "models/black_scholes.h"
-#include "utils/math_utils.h" // For normal_cdf
+#include "utils/adjoint.h"    // For adjoint::Tape, adjoint::ActiveTape, adjoint::Real
 
 #include <cmath>    // For std::log, std::sqrt, std::exp
 #include <algorithm>// For std::max
 #include <iostream> // For debugging (can be removed in production)
 
-double black_scholes_price(double spot_price, double strike_price, double time_to_expiration,
-                           double risk_free_rate, double dividend_yield, double volatility, char type) {
-    if (time_to_expiration <= 0.0) { // Handle options at or past expiration
-        if (type == 'C') {
-            return std::max(0.0, spot_price - strike_price);
-        } else { // Put
-            return std::max(0.0, strike_price - spot_price);
-        }
-    }
-    if (volatility <= 0.0) { // Handle zero or negative volatility
-        // This is a degenerate case, options have no extrinsic value
-        if (type == 'C') {
-            return std::max(0.0, spot_price * std::exp(-dividend_yield * time_to_expiration) - strike_price * std::exp(-risk_free_rate * time_to_expiration));
-        } else { // Put
-            return std::max(0.0, strike_price * std::exp(-risk_free_rate * time_to_expiration) - spot_price * std::exp(-dividend_yield * time_to_expiration));
-        }
+BlackScholesSensitivities black_scholes_sensitivities(double spot_price, double strike_price, double time_to_expiration,
+                                                      double risk_free_rate, double dividend_yield, double volatility,
+                                                      OptionType type) {
+    thread_local adjoint::Tape tape; // Reused so the arena only grows once per thread
+    tape.rewind();
+
+    adjoint::Real spot, strike, time, rate, yield, vol, price;
+    {
+        // Restores the caller's tape afterwards, so this can be called while a caller is recording
+        adjoint::ActiveTape recording(tape);
+        spot = tape.input(spot_price);
+        strike = tape.input(strike_price);
+        time = tape.input(time_to_expiration);
+        rate = tape.input(risk_free_rate);
+        yield = tape.input(dividend_yield);
+        vol = tape.input(volatility);
+
+        price = black_scholes_price<adjoint::Real>(spot, strike, time, rate, yield, vol, type);
     }
+    tape.propagate(price);
 
-    double d1 = (std::log(spot_price / strike_price) + (risk_free_rate - dividend_yield + 0.5 * volatility * volatility) * time_to_expiration) /
-                (volatility * std::sqrt(time_to_expiration));
-    double d2 = d1 - volatility * std::sqrt(time_to_expiration);
+    BlackScholesSensitivities result;
+    result.price = price.value();
+    result.delta = tape.adjoint(spot);
+    result.vega = tape.adjoint(vol);
+    result.rho = tape.adjoint(rate);
+    result.dividend_rho = tape.adjoint(yield);
+    result.theta = tape.adjoint(time);
+    result.strike_delta = tape.adjoint(strike);
+    return result;
+}
 
-    if (type == 'C') {
-        return spot_price * std::exp(-dividend_yield * time_to_expiration) * normal_cdf(d1) -
-               strike_price * std::exp(-risk_free_rate * time_to_expiration) * normal_cdf(d2);
-    } else { // Put
-        return strike_price * std::exp(-risk_free_rate * time_to_expiration) * normal_cdf(-d2) -
-               spot_price * std::exp(-dividend_yield * time_to_expiration) * normal_cdf(-d1);
+BlackScholesSensitivities black_scholes_sensitivities(const ExpiryFactors& factors, double strike_price,
+                                                      double volatility, OptionType type) {
+    BlackScholesSensitivities result;
+    const double time = factors.time_to_expiration;
+    const double spot = factors.forward * factors.discount_factor / factors.dividend_factor;
+    const double sign = (type == OptionType::Call) ? 1.0 : -1.0;
+    if (time <= 0.0 || volatility <= 0.0) { // No extrinsic value: only the intrinsic payoff moves
+        result.price = black_scholes_price<double>(factors, strike_price, volatility, type);
+        bool in_the_money = sign * (factors.forward - strike_price) > 0.0;
+        result.delta = in_the_money ? sign * factors.dividend_factor : 0.0;
+        result.strike_delta = in_the_money ? -sign * factors.discount_factor : 0.0;
+        return result;
     }
+
+    const double vol_sqrt_time = volatility * factors.sqrt_time;
+    const double d1 = std::log(factors.forward / strike_price) / vol_sqrt_time + 0.5 * vol_sqrt_time;
+    const double d2 = d1 - vol_sqrt_time;
+    const double n_d1 = normal_cdf(sign * d1);               // N(d1) for calls, N(-d1) for puts
+    const double n_d2 = normal_cdf(sign * d2);
+    const double spot_discount = spot * factors.dividend_factor;
+    const double strike_discount = strike_price * factors.discount_factor;
+
+    result.price = sign * (spot_discount * n_d1 - strike_discount * n_d2);
+    result.delta = sign * factors.dividend_factor * n_d1;
+    result.vega = spot_discount * normal_pdf(d1) * factors.sqrt_time;
+    result.rho = sign * strike_discount * time * n_d2;
+    result.dividend_rho = -sign * spot_discount * time * n_d1;
+    result.theta = spot_discount * normal_pdf(d1) * volatility / (2.0 * factors.sqrt_time)
+                   + sign * (factors.rate * strike_discount * n_d2 - factors.dividend_yield * spot_discount * n_d1);
+    result.strike_delta = -sign * factors.discount_factor * n_d2;
+    return result;
 }
 
 double implied_volatility_bisection(const OptionData& option, const MarketData& market,
                                     double tolerance, int max_iterations) {
+    return implied_volatility_bisection(option, make_expiry_factors(market, option.time_to_expiration),
+                                        tolerance, max_iterations);
+}
+
+double implied_volatility_bisection(const OptionData& option, const ExpiryFactors& factors,
+                                    double tolerance, int max_iterations) {
     double low_vol = 0.001; // Minimum possible volatility (e.g., 0.1%)
     double high_vol = 5.0;  // Maximum possible volatility (e.g., 500%)
     double mid_vol;
@@ -55,9 +95,7 @@ double implied_volatility_bisection(const OptionData& option, const MarketData&
         // Ensure mid_vol is positive to avoid issues with black_scholes_price
         if (mid_vol <= 0) mid_vol = 0.0001; // Small positive value
 
-        double calculated_price = black_scholes_price(market.spot_price, option.strike_price,
-                                                      option.time_to_expiration, market.risk_free_rate,
-                                                      market.dividend_yield, mid_vol, option.type);
+        double calculated_price = black_scholes_price<double>(factors, option.strike_price, mid_vol, option.type);
         price_diff = calculated_price - option.market_price;
 
         if (std::abs(price_diff) < tolerance) {
@@ -0,0 +1,667 @@
+#include "models/heston.h"
+#include "data/expiry_factors.h" // For make_expiry_factors
+#include "utils/math_utils.h" // For normal_cdf
+
+#include <algorithm>  // For std::sort, std::unique, std::lower_bound, std::upper_bound, std::clamp, std::min, std::max
+#include <array>      // For std::array
+#include <cmath>      // For std::cos, std::sin, std::log, std::exp, std::sqrt
+#include <complex>    // For std::complex
+#include <iostream>   // For warnings
+#include <limits>     // For std::numeric_limits
+#include <numbers>    // For std::numbers::pi
+#include <thread>     // For std::thread
+#include <utility>    // For std::pair
+
+namespace {
+
+    using Complex = std::complex<double>;
+
+    constexpr int PARAMETER_COUNT = 5;
+    constexpr int PANEL_NODES = 16;                // Gauss-Legendre nodes per panel
+    constexpr int INITIAL_PANELS = 4;              // Panels the grid starts from before bisection
+    constexpr int MAX_PANELS = 2048;               // Narrowest panel width is limit / MAX_PANELS
+    constexpr double PANEL_TOLERANCE = 1e-12;      // Bisection stops when a panel's integrals change less than this
+    constexpr double TRUNCATION_TOLERANCE = 1e-12; // |phi(u)| below which the integrand is dropped
+    constexpr double MIN_INTEGRATION_LIMIT = 10.0;
+    constexpr double MAX_INTEGRATION_LIMIT = 2.0e4;
+    constexpr Complex I{0.0, 1.0};
+
+    // --- Gauss-Legendre rule on [0, 1], repeated over the panels of each expiry's grid ---
+
+    struct Quadrature {
+        std::array<double, PANEL_NODES> nodes{};
+        std::array<double, PANEL_NODES> weights{};
+    };
+
+    Quadrature build_quadrature() {
+        Quadrature q;
+        const int n = PANEL_NODES;
+        for (int i = 0; i < (n + 1) / 2; ++i) {
+            double x = std::cos(std::numbers::pi * (i + 0.75) / (n + 0.5));
+            double derivative = 0.0;
+            for (int newton = 0; newton < 100; ++newton) {
+                double p0 = 1.0;
+                double p1 = x;
+                for (int k = 2; k <= n; ++k) {
+                    double p2 = ((2.0 * k - 1.0) * x * p1 - (k - 1.0) * p0) / k;
+                    p0 = p1;
+                    p1 = p2;
+                }
+                derivative = n * (x * p1 - p0) / (x * x - 1.0);
+                double step = p1 / derivative;
+                x -= step;
+                if (std::abs(step) < 1e-15) break;
+            }
+            double weight = 2.0 / ((1.0 - x * x) * derivative * derivative);
+            // Map [-1, 1] to [0, 1]
+            q.nodes[i] = 0.5 * (1.0 - x);
+            q.nodes[n - 1 - i] = 0.5 * (1.0 + x);
+            q.weights[i] = q.weights[n - 1 - i] = 0.5 * weight;
+        }
+        return q;
+    }
+
+    const Quadrature& quadrature() {
+        static const Quadrature q = build_quadrature();
+        return q;
+    }
+
+    // --- Complex forward-mode dual number carrying d/d(parameter) for all five parameters ---
+
+    struct Dual {
+        Complex value;
+        std::array<Complex, PARAMETER_COUNT> grad{};
+
+        Dual(Complex v = {}) : value(v) {}
+
+        static Dual parameter(double v, int index) {
+            Dual result(v);
+            result.grad[index] = 1.0;
+            return result;
+        }
+    };
+
+    Dual operator+(const Dual& a, const Dual& b) {
+        Dual r(a.value + b.value);
+        for (int k = 0; k < PARAMETER_COUNT; ++k) r.grad[k] = a.grad[k] + b.grad[k];
+        return r;
+    }
+    Dual operator-(const Dual& a, const Dual& b) {
+        Dual r(a.value - b.value);
+        for (int k = 0; k < PARAMETER_COUNT; ++k) r.grad[k] = a.grad[k] - b.grad[k];
+        return r;
+    }
+    Dual operator*(const Dual& a, const Dual& b) {
+        Dual r(a.value * b.value);
+        for (int k = 0; k < PARAMETER_COUNT; ++k) r.grad[k] = a.grad[k] * b.value + a.value * b.grad[k];
+        return r;
+    }
+    Dual operator/(const Dual& a, const Dual& b) {
+        Complex inverse = 1.0 / b.value;
+        Dual r(a.value * inverse);
+        for (int k = 0; k < PARAMETER_COUNT; ++k) r.grad[k] = (a.grad[k] - r.value * b.grad[k]) * inverse;
+        return r;
+    }
+    Dual operator-(const Dual& a) {
+        Dual r(-a.value);
+        for (int k = 0; k < PARAMETER_COUNT; ++k) r.grad[k] = -a.grad[k];
+        return r;
+    }
+
+    // Mixed operations with constants avoid carrying zero gradients.
+    Dual operator+(const Dual& a, Complex b) { Dual r = a; r.value += b; return r; }
+    Dual operator+(Complex a, const Dual& b) { return b + a; }
+    Dual operator-(const Dual& a, Complex b) { Dual r = a; r.value -= b; return r; }
+    Dual operator-(Complex a, const Dual& b) { Dual r = -b; r.value += a; return r; }
+    Dual operator*(const Dual& a, Complex b) {
+        Dual r(a.value * b);
+        for (int k = 0; k < PARAMETER_COUNT; ++k) r.grad[k] = a.grad[k] * b;
+        return r;
+    }
+    Dual operator*(Complex a, const Dual& b) { return b * a; }
+
+    Dual exp(const Dual& x) {
+        Dual r(std::exp(x.value));
+        for (int k = 0; k < PARAMETER_COUNT; ++k) r.grad[k] = r.value * x.grad[k];
+        return r;
+    }
+    Dual log(const Dual& x) {
+        Dual r(std::log(x.value));
+        Complex inverse = 1.0 / x.value;
+        for (int k = 0; k < PARAMETER_COUNT; ++k) r.grad[k] = x.grad[k] * inverse;
+        return r;
+    }
+    Dual sqrt(const Dual& x) {
+        Dual r(std::sqrt(x.value));
+        Complex half_inverse = 0.5 / r.value;
+        for (int k = 0; k < PARAMETER_COUNT; ++k) r.grad[k] = x.grad[k] * half_inverse;
+        return r;
+    }
+
+    // --- Characteristic function ---
+
+    // Log of the characteristic function of log(S_T), E[exp(iu log S_T)], in the
+    // formulation of Cui et al. (2017), which avoids the branch-cut discontinuity
+    // of the original Heston form. Templated so the same code runs on plain
+    // complex numbers (pricing) and on Dual (pricing plus parameter gradients).
+    template <typename C>
+    C log_characteristic_function(Complex u, double tau, double log_forward,
+                                  const C& v0, const C& theta, const C& rho, const C& kappa, const C& sigma) {
+        using std::exp;
+        using std::log;
+        using std::sqrt;
+
+        const Complex iu = I * u;
+        const Complex u2_iu = u * u + iu;
+        C xi = kappa - sigma * rho * iu;
+        C d = sqrt(xi * xi + sigma * sigma * u2_iu);
+        C e = exp(-d * Complex(tau));
+        C one_minus_e = Complex(1.0) - e;
+        C a = v0 * u2_iu * one_minus_e / (d * (Complex(1.0) + e) + xi * one_minus_e);
+        C log_b = log(d) + (kappa - d) * Complex(0.5 * tau) - log((d + xi) * Complex(0.5) + (d - xi) * e * Complex(0.5));
+        return iu * log_forward - kappa * theta * rho * iu * Complex(tau) / sigma - a
+               + Complex(2.0) * kappa * theta / (sigma * sigma) * log_b;
+    }
+
+    // Strike-independent part of the pricing integral for one expiry. A Black-Scholes
+    // call with the same expected integrated variance is used as a control variate,
+    // which leaves only the (small) difference of characteristic functions to integrate:
+    //   call = BS(F, K, w) + e^{-r tau} / pi * sum_j Re[ e^{-i u_j ln(K/F)} (left_j - K right_j) ]
+    // with left_j  = w_j F (phi(u_j - i) - phi_bs(u_j - i)) / (i u_j),
+    //      right_j = w_j     (phi(u_j)     - phi_bs(u_j))     / (i u_j),
+    // where phi is the characteristic function of log(S_T / F).
+    //
+    // The grid is sized per expiry (see init_expiry), so buffers are vectors that
+    // keep their capacity when the terms are rebuilt during calibration.
+    struct ExpiryTerms {
+        double time_to_expiration{};
+        double discount{};              // e^{-r tau}
+        double forward{};               // S e^{(r - q) tau}
+        double log_forward{};
+        double integrated_variance{};   // Control variate variance: E[int_0^tau v_t dt]
+        std::vector<double> nodes;      // u_j
+        std::vector<double> weights;    // w_j
+        std::vector<Complex> left;
+        std::vector<Complex> right;
+        // Gradients of left/right with respect to the parameters (only when requested).
+        // The control variate does not change the price, so it does not enter the gradient.
+        std::vector<std::array<Complex, PARAMETER_COUNT>> left_grad;
+        std::vector<std::array<Complex, PARAMETER_COUNT>> right_grad;
+
+        std::size_t node_count() const { return nodes.size(); }
+    };
+
+    Complex black_scholes_characteristic_function(Complex u, double integrated_variance) {
+        return std::exp(-0.5 * integrated_variance * (u * u + I * u));
+    }
+
+    void fill_expiry_node(ExpiryTerms& terms, std::size_t j, const HestonParameters& p, bool with_gradient) {
+        const double u = terms.nodes[j];
+        const Complex scale = terms.weights[j] / (I * u);
+        const Complex left_scale = terms.forward * scale;
+        const double tau = terms.time_to_expiration;
+        const Complex left_control = black_scholes_characteristic_function(u - I, terms.integrated_variance);
+        const Complex right_control = black_scholes_characteristic_function(Complex(u), terms.integrated_variance);
+
+        if (!with_gradient) {
+            Complex v0(p.initial_variance), theta(p.long_run_variance), rho(p.correlation),
+                    kappa(p.mean_reversion), sigma(p.vol_of_vol);
+            terms.left[j] = left_scale * (std::exp(log_characteristic_function(u - I, tau, 0.0, v0, theta, rho, kappa, sigma)) - left_control);
+            terms.right[j] = scale * (std::exp(log_characteristic_function(Complex(u), tau, 0.0, v0, theta, rho, kappa, sigma)) - right_control);
+            return;
+        }
+
+        Dual v0 = Dual::parameter(p.initial_variance, 0);
+        Dual theta = Dual::parameter(p.long_run_variance, 1);
+        Dual rho = Dual::parameter(p.correlation, 2);
+        Dual kappa = Dual::parameter(p.mean_reversion, 3);
+        Dual sigma = Dual::parameter(p.vol_of_vol, 4);
+        Dual left = (exp(log_characteristic_function(u - I, tau, 0.0, v0, theta, rho, kappa, sigma)) - left_control) * left_scale;
+        Dual right = (exp(log_characteristic_function(Complex(u), tau, 0.0, v0, theta, rho, kappa, sigma)) - right_control) * scale;
+        terms.left[j] = left.value;
+        terms.right[j] = right.value;
+        terms.left_grad[j] = left.grad;
+        terms.right_grad[j] = right.grad;
+    }
+
+    // Strike-independent integrand at one u, without the quadrature weight:
+    // (phi(u - i) - phi_bs(u - i)) / (iu) and (phi(u) - phi_bs(u)) / (iu).
+    std::pair<Complex, Complex> integrand(double u, double tau, double integrated_variance, const HestonParameters& p) {
+        Complex v0(p.initial_variance), theta(p.long_run_variance), rho(p.correlation),
+                kappa(p.mean_reversion), sigma(p.vol_of_vol);
+        Complex inverse = 1.0 / (I * u);
+        Complex left = std::exp(log_characteristic_function(u - I, tau, 0.0, v0, theta, rho, kappa, sigma))
+                       - black_scholes_characteristic_function(u - I, integrated_variance);
+        Complex right = std::exp(log_characteristic_function(Complex(u), tau, 0.0, v0, theta, rho, kappa, sigma))
+                        - black_scholes_characteristic_function(Complex(u), integrated_variance);
+        return {left * inverse, right * inverse};
+    }
+
+    // Gauss-Legendre integrals over [a, b] of both integrand terms, each rotated by
+    // e^{-iuk} for the extreme log-moneyness values of the expiry and at the money.
+    using PanelIntegrals = std::array<Complex, 6>;
+
+    PanelIntegrals integrate_panel(double a, double b, double tau, double integrated_variance,
+                                   double max_abs_log_moneyness, const HestonParameters& p) {
+        const Quadrature& q = quadrature();
+        const double log_moneyness[3] = {-max_abs_log_moneyness, 0.0, max_abs_log_moneyness};
+        PanelIntegrals sums{};
+        for (int i = 0; i < PANEL_NODES; ++i) {
+            double u = a + (b - a) * q.nodes[i];
+            auto [left, right] = integrand(u, tau, integrated_variance, p);
+            for (int r = 0; r < 3; ++r) {
+                Complex rotation = (b - a) * q.weights[i] * std::polar(1.0, -u * log_moneyness[r]);
+                sums[2 * r] += rotation * left;
+                sums[2 * r + 1] += rotation * right;
+            }
+        }
+        return sums;
+    }
+
+    double largest_difference(const PanelIntegrals& coarse, const PanelIntegrals& first_half,
+                              const PanelIntegrals& second_half) {
+        double largest = 0.0;
+        for (std::size_t r = 0; r < coarse.size(); ++r) {
+            largest = std::max(largest, std::abs(coarse[r] - first_half[r] - second_half[r]));
+        }
+        return largest;
+    }
+
+    // Sets up an expiry: discounting, the control variate and the quadrature grid.
+    //
+    // The grid runs to where |phi| falls below TRUNCATION_TOLERANCE, which for small
+    // v * tau is far out (phi decays like exp(-v tau u^2 / 2), and only linearly in
+    // u once the vol of vol dominates). It is split into panels of PANEL_NODES
+    // Gauss-Legendre nodes, chosen by adaptive bisection: a panel is kept once its
+    // integral agrees with the sum over its two halves to PANEL_TOLERANCE, and is
+    // split otherwise. The check is made for the widest strikes of the expiry
+    // (max_abs_log_moneyness = max |ln(K/F)|), whose rotation e^{-iu ln(K/F)} the
+    // grid has to resolve on top of phi itself, so panels are narrow where the
+    // integrand changes fast and wide in the tail.
+    void init_expiry(ExpiryTerms& terms, const ExpiryFactors& factors, const HestonParameters& p,
+                     double max_abs_log_moneyness) {
+        const double time_to_expiration = factors.time_to_expiration;
+        terms.time_to_expiration = time_to_expiration;
+        terms.discount = factors.discount_factor;
+        terms.forward = factors.forward;
+        terms.log_forward = std::log(terms.forward);
+
+        double kappa_tau = p.mean_reversion * time_to_expiration;
+        double reversion_weight = kappa_tau > 1e-8 ? (1.0 - std::exp(-kappa_tau)) / kappa_tau : 1.0;
+        terms.integrated_variance = (p.long_run_variance + (p.initial_variance - p.long_run_variance) * reversion_weight)
+                                    * time_to_expiration;
+
+        Complex v0(p.initial_variance), theta(p.long_run_variance), rho(p.correlation),
+                kappa(p.mean_reversion), sigma(p.vol_of_vol);
+        auto above_tolerance = [&](double u) {
+            const double log_tolerance = std::log(TRUNCATION_TOLERANCE);
+            return std::real(log_characteristic_function(Complex(u), time_to_expiration, 0.0, v0, theta, rho, kappa, sigma)) > log_tolerance ||
+                   std::real(log_characteristic_function(u - I, time_to_expiration, 0.0, v0, theta, rho, kappa, sigma)) > log_tolerance;
+        };
+        double limit = MIN_INTEGRATION_LIMIT;
+        while (limit < MAX_INTEGRATION_LIMIT && above_tolerance(limit)) {
+            limit *= 1.25;
+        }
+        limit = std::min(limit, MAX_INTEGRATION_LIMIT);
+
+        struct Panel {
+            double a;
+            double b;
+            PanelIntegrals integrals;
+        };
+        const double tau = time_to_expiration;
+        const double variance = terms.integrated_variance;
+        const double min_width = limit / MAX_PANELS;
+        const Quadrature& q = quadrature();
+        terms.nodes.clear();
+        terms.weights.clear();
+
+        // Depth-first over panels, left to right, so the nodes come out in increasing order
+        std::vector<Panel> pending;
+        for (int i = INITIAL_PANELS; i-- > 0;) {
+            double a = limit * i / INITIAL_PANELS;
+            double b = limit * (i + 1) / INITIAL_PANELS;
+            pending.push_back(Panel{a, b, integrate_panel(a, b, tau, variance, max_abs_log_moneyness, p)});
+        }
+        while (!pending.empty()) {
+            Panel panel = pending.back();
+            pending.pop_back();
+            double middle = 0.5 * (panel.a + panel.b);
+            PanelIntegrals first = integrate_panel(panel.a, middle, tau, variance, max_abs_log_moneyness, p);
+            PanelIntegrals second = integrate_panel(middle, panel.b, tau, variance, max_abs_log_moneyness, p);
+            if (panel.b - panel.a > min_width && largest_difference(panel.integrals, first, second) > PANEL_TOLERANCE) {
+                pending.push_back(Panel{middle, panel.b, second});
+                pending.push_back(Panel{panel.a, middle, first});
+                continue;
+            }
+            for (int i = 0; i < PANEL_NODES; ++i) {
+                terms.nodes.push_back(panel.a + (panel.b - panel.a) * q.nodes[i]);
+                terms.weights.push_back((panel.b - panel.a) * q.weights[i]);
+            }
+        }
+
+        const std::size_t count = terms.nodes.size();
+        terms.left.resize(count);
+        terms.right.resize(count);
+    }
+
+    // Prices one contract from the cached expiry terms; fills `gradient` if non-null.
+    double price_from_terms(const ExpiryTerms& terms, const OptionData& option,
+                            std::array<double, PARAMETER_COUNT>* gradient) {
+        const double strike = option.strike_price;
+        const double log_moneyness = std::log(strike) - terms.log_forward;
+
+        double integral = 0.0;
+        std::array<double, PARAMETER_COUNT> grad_integral{};
+        for (std::size_t j = 0; j < terms.node_count(); ++j) {
+            double angle = terms.nodes[j] * log_moneyness;
+            Complex rotation(std::cos(angle), -std::sin(angle));
+            integral += (rotation * (terms.left[j] - strike * terms.right[j])).real();
+            if (gradient) {
+                for (int k = 0; k < PARAMETER_COUNT; ++k) {
+                    grad_integral[k] += (rotation * (terms.left_grad[j][k] - strike * terms.right_grad[j][k])).real();
+                }
+            }
+        }
+
+        // Black-Scholes control variate in forward form
+        double total_vol = std::sqrt(terms.integrated_variance);
+        double d1 = (-log_moneyness + 0.5 * terms.integrated_variance) / total_vol;
+        double control = terms.discount * (terms.forward * normal_cdf(d1) - strike * normal_cdf(d1 - total_vol));
+
+        const double factor = terms.discount / std::numbers::pi;
+        double call = control + factor * integral;
+        double price = option.type == OptionType::Call ? call
+                                                       : call - terms.discount * (terms.forward - strike); // Put-call parity (same gradient)
+
+        // No-arbitrage floor: quadrature noise must not push a far out-of-the-money
+        // price below the discounted intrinsic forward value (or below zero).
+        double intrinsic = option.type == OptionType::Call ? terms.forward - strike : strike - terms.forward;
+        double floor = terms.discount * std::max(intrinsic, 0.0);
+        bool floored = price < floor;
+        if (gradient) {
+            for (int k = 0; k < PARAMETER_COUNT; ++k) (*gradient)[k] = floored ? 0.0 : factor * grad_integral[k];
+        }
+        return floored ? floor : price;
+    }
+
+    // Runs fn(begin, end) over [0, count) split across up to `threads` threads.
+    template <typename Fn>
+    void parallel_for(std::size_t count, unsigned threads, Fn fn) {
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, count));
+        if (threads <= 1) {
+            fn(std::size_t{0}, count);
+            return;
+        }
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+        std::size_t chunk = (count + threads - 1) / threads;
+        for (unsigned t = 1; t < threads; ++t) {
+            std::size_t begin = std::min(count, t * chunk);
+            std::size_t end = std::min(count, begin + chunk);
+            workers.emplace_back(fn, begin, end);
+        }
+        fn(std::size_t{0}, std::min(count, chunk));
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Distinct expiries of a chain and, for each contract, the index of its expiry.
+    struct ExpiryGrouping {
+        std::vector<double> expiries;
+        std::vector<ExpiryFactors> factors; // Discount factor and forward of each expiry, taken from the curves once
+        std::vector<std::size_t> contract_expiry;
+        std::vector<double> min_strike;  // Strike range of each expiry, which sizes its grid
+        std::vector<double> max_strike;
+    };
+
+    ExpiryGrouping group_by_expiry(const std::vector<OptionData>& chain, double spot_price, const TermStructure& rates,
+                                   const TermStructure& dividends) {
+        ExpiryGrouping grouping;
+        for (const OptionData& option : chain) grouping.expiries.push_back(option.time_to_expiration);
+        std::sort(grouping.expiries.begin(), grouping.expiries.end());
+        grouping.expiries.erase(std::unique(grouping.expiries.begin(), grouping.expiries.end()), grouping.expiries.end());
+        grouping.factors.reserve(grouping.expiries.size());
+        for (double expiry : grouping.expiries) {
+            grouping.factors.push_back(make_expiry_factors(spot_price, rates, dividends, expiry));
+        }
+        grouping.contract_expiry.reserve(chain.size());
+        grouping.min_strike.assign(grouping.expiries.size(), std::numeric_limits<double>::infinity());
+        grouping.max_strike.assign(grouping.expiries.size(), 0.0);
+        for (const OptionData& option : chain) {
+            auto it = std::lower_bound(grouping.expiries.begin(), grouping.expiries.end(), option.time_to_expiration);
+            std::size_t expiry = static_cast<std::size_t>(it - grouping.expiries.begin());
+            grouping.contract_expiry.push_back(expiry);
+            grouping.min_strike[expiry] = std::min(grouping.min_strike[expiry], option.strike_price);
+            grouping.max_strike[expiry] = std::max(grouping.max_strike[expiry], option.strike_price);
+        }
+        return grouping;
+    }
+
+    // Largest |ln(K/F)| over a strike range.
+    double max_abs_log_moneyness(double min_strike, double max_strike, double forward) {
+        if (!(min_strike > 0.0) || !(forward > 0.0)) return 0.0;
+        return std::max(std::abs(std::log(min_strike / forward)), std::abs(std::log(max_strike / forward)));
+    }
+
+    // Builds the cached terms of every expiry, spreading (expiry, node) pairs over threads.
+    void build_expiry_terms(std::vector<ExpiryTerms>& terms, const ExpiryGrouping& grouping,
+                            const HestonParameters& params, bool with_gradient, unsigned threads) {
+        terms.resize(grouping.expiries.size());
+        std::vector<std::size_t> first_node(terms.size() + 1, 0); // Node offsets of each expiry in the flattened range
+        for (std::size_t e = 0; e < terms.size(); ++e) {
+            const ExpiryFactors& factors = grouping.factors[e];
+            init_expiry(terms[e], factors, params,
+                        max_abs_log_moneyness(grouping.min_strike[e], grouping.max_strike[e], factors.forward));
+            if (with_gradient) {
+                terms[e].left_grad.resize(terms[e].node_count());
+                terms[e].right_grad.resize(terms[e].node_count());
+            }
+            first_node[e + 1] = first_node[e] + terms[e].node_count();
+        }
+        parallel_for(first_node.back(), threads, [&](std::size_t begin, std::size_t end) {
+            std::size_t e = static_cast<std::size_t>(std::upper_bound(first_node.begin(), first_node.end(), begin)
+                                                     - first_node.begin()) - 1;
+            for (std::size_t i = begin; i < end; ++i) {
+                while (i >= first_node[e + 1]) ++e;
+                fill_expiry_node(terms[e], i - first_node[e], params, with_gradient);
+            }
+        });
+    }
+
+    // --- Levenberg-Marquardt helpers ---
+
+    using Vector5 = std::array<double, PARAMETER_COUNT>;
+    using Matrix5 = std::array<Vector5, PARAMETER_COUNT>;
+
+    Vector5 to_vector(const HestonParameters& p) {
+        return {p.initial_variance, p.long_run_variance, p.correlation, p.mean_reversion, p.vol_of_vol};
+    }
+
+    // Keeps parameters in a box where the characteristic function is well defined.
+    HestonParameters to_parameters(const Vector5& v) {
+        return HestonParameters{std::clamp(v[0], 1e-6, 4.0), std::clamp(v[1], 1e-6, 4.0),
+                                std::clamp(v[2], -0.999, 0.999), std::clamp(v[3], 1e-4, 20.0),
+                                std::clamp(v[4], 1e-4, 5.0)};
+    }
+
+    // Solves a * x = b by Gaussian elimination with partial pivoting. Returns false if singular.
+    bool solve5(Matrix5 a, Vector5 b, Vector5& x) {
+        for (int col = 0; col < PARAMETER_COUNT; ++col) {
+            int pivot = col;
+            for (int row = col + 1; row < PARAMETER_COUNT; ++row) {
+                if (std::abs(a[row][col]) > std::abs(a[pivot][col])) pivot = row;
+            }
+            if (std::abs(a[pivot][col]) < 1e-300) return false;
+            std::swap(a[col], a[pivot]);
+            std::swap(b[col], b[pivot]);
+            for (int row = col + 1; row < PARAMETER_COUNT; ++row) {
+                double f = a[row][col] / a[col][col];
+                for (int k = col; k < PARAMETER_COUNT; ++k) a[row][k] -= f * a[col][k];
+                b[row] -= f * b[col];
+            }
+        }
+        for (int row = PARAMETER_COUNT - 1; row >= 0; --row) {
+            double sum = b[row];
+            for (int k = row + 1; k < PARAMETER_COUNT; ++k) sum -= a[row][k] * x[k];
+            x[row] = sum / a[row][row];
+        }
+        return true;
+    }
+
+} // namespace
+
+double heston_price(const OptionData& option, const ExpiryFactors& factors, const HestonParameters& params) {
+    if (factors.time_to_expiration <= 0.0) { // Handle options at or past expiration (the forward is then spot)
+        double intrinsic = (option.type == OptionType::Call) ? factors.forward - option.strike_price
+                                                             : option.strike_price - factors.forward;
+        return std::max(0.0, intrinsic);
+    }
+    ExpiryTerms terms;
+    init_expiry(terms, factors, params, max_abs_log_moneyness(option.strike_price, option.strike_price, factors.forward));
+    for (std::size_t j = 0; j < terms.node_count(); ++j) {
+        fill_expiry_node(terms, j, params, false);
+    }
+    return price_from_terms(terms, option, nullptr);
+}
+
+double heston_price(const OptionData& option, const MarketData& market, const HestonParameters& params) {
+    return heston_price(option, make_expiry_factors(market, option.time_to_expiration), params);
+}
+
+std::vector<double> heston_prices(const std::vector<OptionData>& chain, double spot_price, const TermStructure& rates,
+                                  const TermStructure& dividends, const HestonParameters& params) {
+    std::vector<double> prices(chain.size());
+    ExpiryGrouping grouping = group_by_expiry(chain, spot_price, rates, dividends);
+    std::vector<ExpiryTerms> terms;
+    build_expiry_terms(terms, grouping, params, false, 1);
+    for (std::size_t i = 0; i < chain.size(); ++i) {
+        std::size_t expiry = grouping.contract_expiry[i];
+        prices[i] = chain[i].time_to_expiration > 0.0 ? price_from_terms(terms[expiry], chain[i], nullptr)
+                                                      : heston_price(chain[i], grouping.factors[expiry], params);
+    }
+    return prices;
+}
+
+std::vector<double> heston_prices(const std::vector<OptionData>& chain, const MarketData& market,
+                                  const HestonParameters& params) {
+    return heston_prices(chain, market.spot_price, TermStructure(market.risk_free_rate),
+                         TermStructure(market.dividend_yield), params);
+}
+
+HestonCalibrationResult calibrate_heston(const std::vector<OptionData>& chain, double spot_price,
+                                         const TermStructure& rates, const TermStructure& dividends,
+                                         const HestonParameters& initial_guess,
+                                         const HestonCalibrationOptions& options) {
+    HestonCalibrationResult result;
+    result.parameters = to_parameters(to_vector(initial_guess));
+
+    std::vector<OptionData> contracts;
+    for (const OptionData& option : chain) {
+        if (option.time_to_expiration > 0.0 && option.strike_price > 0.0 && option.market_price > 0.0) {
+            contracts.push_back(option);
+        }
+    }
+    if (contracts.empty() || spot_price <= 0.0) {
+        std::cerr << "Warning: No valid contracts to calibrate the Heston model to." << std::endl;
+        return result;
+    }
+
+    const unsigned threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    const ExpiryGrouping grouping = group_by_expiry(contracts, spot_price, rates, dividends);
+    const std::size_t n = contracts.size();
+    std::vector<ExpiryTerms> terms;
+    std::vector<double> residuals(n);
+    std::vector<Vector5> jacobian(n);
+
+    // Fills residuals (and the Jacobian if requested) and returns the sum of squared errors.
+    auto evaluate = [&](const HestonParameters& params, bool with_gradient) {
+        build_expiry_terms(terms, grouping, params, with_gradient, threads);
+        parallel_for(n, threads, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const ExpiryTerms& expiry = terms[grouping.contract_expiry[i]];
+                residuals[i] = price_from_terms(expiry, contracts[i], with_gradient ? &jacobian[i] : nullptr)
+                               - contracts[i].market_price;
+            }
+        });
+        double sse = 0.0;
+        for (double r : residuals) sse += r * r; // Serial sum keeps the result independent of thread count
+        return sse;
+    };
+
+    Vector5 x = to_vector(result.parameters);
+    double cost = evaluate(result.parameters, true);
+    double lambda = 1e-3;
+
+    for (int iteration = 0; iteration < options.max_iterations; ++iteration) {
+        result.iterations = iteration + 1;
+
+        Matrix5 jtj{};
+        Vector5 jtr{};
+        for (std::size_t i = 0; i < n; ++i) {
+            for (int a = 0; a < PARAMETER_COUNT; ++a) {
+                jtr[a] += jacobian[i][a] * residuals[i];
+                for (int b = a; b < PARAMETER_COUNT; ++b) jtj[a][b] += jacobian[i][a] * jacobian[i][b];
+            }
+        }
+        for (int a = 0; a < PARAMETER_COUNT; ++a) {
+            for (int b = 0; b < a; ++b) jtj[a][b] = jtj[b][a];
+        }
+
+        // Try damped steps until one lowers the error (or damping becomes absurd).
+        bool improved = false;
+        while (lambda < 1e12) {
+            Matrix5 damped = jtj;
+            Vector5 negative_gradient{};
+            for (int a = 0; a < PARAMETER_COUNT; ++a) {
+                damped[a][a] += lambda * std::max(jtj[a][a], 1e-12);
+                negative_gradient[a] = -jtr[a];
+            }
+            Vector5 step{};
+            if (!solve5(damped, negative_gradient, step)) {
+                lambda *= 10.0;
+                continue;
+            }
+
+            Vector5 trial_x;
+            for (int a = 0; a < PARAMETER_COUNT; ++a) trial_x[a] = x[a] + step[a];
+            HestonParameters trial = to_parameters(trial_x);
+            double trial_cost = evaluate(trial, false);
+            if (trial_cost < cost) {
+                double relative_improvement = (cost - trial_cost) / std::max(cost, 1e-300);
+                double relative_step = 0.0;
+                for (int a = 0; a < PARAMETER_COUNT; ++a) {
+                    relative_step = std::max(relative_step, std::abs(step[a]) / (std::abs(x[a]) + 1e-8));
+                }
+                x = to_vector(trial);
+                result.parameters = trial;
+                cost = evaluate(trial, true); // Refresh residuals and Jacobian at the accepted point
+                lambda = std::max(lambda / 10.0, 1e-12);
+                improved = true;
+                // Near a zero-residual fit the error sits at the quadrature's noise floor, where
+                // relative improvements stay large while the parameters have stopped moving.
+                if (relative_improvement < options.tolerance || relative_step < std::sqrt(options.tolerance)) {
+                    result.converged = true;
+                }
+                break;
+            }
+            lambda *= 10.0;
+        }
+
+        if (!improved) {
+            result.converged = true; // No descent direction left: at a (local) minimum
+        }
+        if (result.converged) break;
+    }
+
+    result.rmse = std::sqrt(cost / static_cast<double>(n));
+    return result;
+}
+
+HestonCalibrationResult calibrate_heston(const std::vector<OptionData>& chain, const MarketData& market,
+                                         const HestonParameters& initial_guess,
+                                         const HestonCalibrationOptions& options) {
+    return calibrate_heston(chain, market.spot_price, TermStructure(market.risk_free_rate),
+                            TermStructure(market.dividend_yield), initial_guess, options);
+}
@@ -0,0 +1,290 @@
+#include "models/risk_engine.h"
+#include <algorithm> // For std::max
+#include <bit>       // For std::bit_ceil
+#include <cmath>     // For std::abs
+#include <iostream>  // For warnings
+#include <thread>    // For std::this_thread::yield
+
+namespace {
+
+    // A change is allowed if the result is within the limit or moves toward zero.
+    bool within_limit(double current, double change, double limit) {
+        double updated = current + change;
+        return std::abs(updated) <= limit || std::abs(updated) < std::abs(current);
+    }
+
+    // Adds `change` to `value` if `allowed(current)` holds for the value it replaces.
+    // Lock-free: retries only when another thread changed the value in between.
+    template <typename Predicate>
+    bool try_add(std::atomic<double>& value, double change, Predicate allowed) {
+        if (change == 0.0) return true;
+        double current = value.load(std::memory_order_relaxed);
+        do {
+            if (!allowed(current)) return false;
+        } while (!value.compare_exchange_weak(current, current + change, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed));
+        return true;
+    }
+
+    void add(std::atomic<double>& value, double change) {
+        if (change != 0.0) value.fetch_add(change, std::memory_order_acq_rel);
+    }
+
+    // Test-and-test-and-set lock; yields while waiting in case the holder was preempted.
+    class SpinLock {
+    public:
+        explicit SpinLock(std::atomic_flag& flag) : flag_(flag) {
+            for (int spins = 0; flag_.test_and_set(std::memory_order_acquire); ++spins) {
+                while (flag_.test(std::memory_order_relaxed)) {
+                    if (++spins > 64) std::this_thread::yield();
+                }
+            }
+        }
+        ~SpinLock() { flag_.clear(std::memory_order_release); }
+
+        SpinLock(const SpinLock&) = delete;
+        SpinLock& operator=(const SpinLock&) = delete;
+
+    private:
+        std::atomic_flag& flag_;
+    };
+
+} // namespace
+
+RiskEngine::RiskEngine(double total_capital, double max_loss, std::size_t max_underlyings,
+                       std::size_t max_contracts)
+    : total_capital_(total_capital), max_loss_(max_loss), max_underlyings_(max_underlyings),
+      underlyings_(std::make_unique<UnderlyingSlot[]>(max_underlyings)), max_contracts_(max_contracts),
+      contract_mask_(std::bit_ceil(std::max<std::size_t>(2 * max_contracts, 2)) - 1),
+      contracts_(std::make_unique<ContractSlot[]>(contract_mask_ + 1)) {
+    if (total_capital_ <= 0) {
+        std::cerr << "Warning: Total capital must be positive. Setting to 100000.0." << std::endl;
+        total_capital_ = 100000.0;
+    }
+    if (max_loss_ <= 0) {
+        std::cerr << "Warning: Max loss must be positive. Setting to 10% of total capital." << std::endl;
+        max_loss_ = 0.1 * total_capital_;
+    }
+}
+
+std::size_t RiskEngine::add_underlying(const UnderlyingLimits& limits) {
+    if (underlying_count_ == max_underlyings_) {
+        std::cerr << "Error: Risk engine is full (" << max_underlyings_ << " underlyings)." << std::endl;
+        return max_underlyings_;
+    }
+    underlyings_[underlying_count_].limits = limits;
+    return underlying_count_++;
+}
+
+double RiskEngine::loss_headroom() const {
+    double realized = realized_pnl_.load(std::memory_order_relaxed);
+    return max_loss_ - (realized < 0.0 ? -realized : 0.0);
+}
+
+RiskEngine::ContractSlot* RiskEngine::find_contract(std::uint64_t contract_id, bool insert) const {
+    if (contract_id == UINT64_MAX) return nullptr;
+    const std::uint64_t key = contract_id + 1;
+
+    // splitmix64 finalizer spreads sequential ids over the table
+    std::uint64_t hash = contract_id + 0x9e3779b97f4a7c15ull;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    hash ^= hash >> 31;
+
+    // Linear probing. A slot is only claimed after a unit of contract_count_ has been
+    // taken, which caps the table at half full, so probes stay short and always
+    // reach a free slot.
+    for (std::size_t probe = 0; probe <= contract_mask_; ++probe) {
+        ContractSlot& slot = contracts_[(hash + probe) & contract_mask_];
+        std::uint64_t current = slot.key.load(std::memory_order_acquire);
+        if (current == key) return &slot;
+        if (current != 0) continue;
+        if (!insert) return nullptr;
+
+        if (contract_count_.fetch_add(1, std::memory_order_acq_rel) >= max_contracts_) {
+            contract_count_.fetch_sub(1, std::memory_order_acq_rel);
+            return nullptr; // Book full
+        }
+        if (slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) return &slot;
+        contract_count_.fetch_sub(1, std::memory_order_acq_rel); // Lost the slot to another contract
+        if (current == key) return &slot; // Another thread inserted the same contract
+    }
+    return nullptr;
+}
+
+// Binds a new contract to `underlying`, or checks that an existing one belongs to it.
+bool RiskEngine::contract_underlying(ContractSlot& contract, std::size_t underlying) const {
+    std::size_t expected = NO_UNDERLYING;
+    if (contract.underlying.compare_exchange_strong(expected, underlying, std::memory_order_acq_rel)) {
+        return true;
+    }
+    return expected == underlying;
+}
+
+RiskCheckResult RiskEngine::check(const TradeRequest& trade) const {
+    if (trade.underlying >= underlying_count_) return RiskCheckResult::UnknownUnderlying;
+    const UnderlyingSlot& slot = underlyings_[trade.underlying];
+
+    const ContractSlot* contract = find_contract(trade.contract_id, false);
+    if (contract == nullptr && (trade.contract_id == UINT64_MAX || contract_count() >= max_contracts_)) {
+        return RiskCheckResult::PositionBookFull;
+    }
+    if (contract != nullptr) {
+        std::size_t bound = contract->underlying.load(std::memory_order_acquire);
+        if (bound != NO_UNDERLYING && bound != trade.underlying) return RiskCheckResult::UnknownUnderlying;
+    }
+
+    if (trade.capital > 0.0 && used_capital() + trade.capital > total_capital_) {
+        return RiskCheckResult::CapitalLimit;
+    }
+    if (trade.max_loss > 0.0 && reserved_loss() + trade.max_loss > loss_headroom()) {
+        return RiskCheckResult::LossLimit;
+    }
+    if (!within_limit(slot.delta.load(std::memory_order_relaxed), trade.delta, slot.limits.max_abs_delta)) {
+        return RiskCheckResult::DeltaLimit;
+    }
+    if (!within_limit(slot.vega.load(std::memory_order_relaxed), trade.vega, slot.limits.max_abs_vega)) {
+        return RiskCheckResult::VegaLimit;
+    }
+    return RiskCheckResult::Accepted;
+}
+
+RiskCheckResult RiskEngine::reserve(const TradeRequest& trade) {
+    if (trade.underlying >= underlying_count_) return RiskCheckResult::UnknownUnderlying;
+    UnderlyingSlot& slot = underlyings_[trade.underlying];
+
+    // An existing contract must belong to this underlying. A new one is only
+    // claimed once the trade has passed every limit, so rejected trades never
+    // take a slot.
+    ContractSlot* contract = find_contract(trade.contract_id, false);
+    if (contract != nullptr) {
+        std::size_t bound = contract->underlying.load(std::memory_order_acquire);
+        if (bound != NO_UNDERLYING && bound != trade.underlying) return RiskCheckResult::UnknownUnderlying;
+    }
+
+    // Capital and loss that a trade frees are only applied once it is accepted,
+    // so a rollback below only ever undoes usage that was added: concurrent
+    // trades may briefly see less headroom than there is, never more.
+    double capital_increase = trade.capital > 0.0 ? trade.capital : 0.0;
+    double loss_increase = trade.max_loss > 0.0 ? trade.max_loss : 0.0;
+
+    if (!try_add(used_capital_, capital_increase, [&](double used) {
+            return capital_increase == 0.0 || used + capital_increase <= total_capital_;
+        })) {
+        return RiskCheckResult::CapitalLimit;
+    }
+
+    double headroom = loss_headroom();
+    if (!try_add(reserved_loss_, loss_increase, [&](double reserved) {
+            return loss_increase == 0.0 || reserved + loss_increase <= headroom;
+        })) {
+        add(used_capital_, -capital_increase);
+        return RiskCheckResult::LossLimit;
+    }
+
+    RiskCheckResult result = RiskCheckResult::Accepted;
+    {
+        SpinLock guard(slot.lock);
+        double delta = slot.delta.load(std::memory_order_relaxed);
+        double vega = slot.vega.load(std::memory_order_relaxed);
+        if (!within_limit(delta, trade.delta, slot.limits.max_abs_delta)) {
+            result = RiskCheckResult::DeltaLimit;
+        } else if (!within_limit(vega, trade.vega, slot.limits.max_abs_vega)) {
+            result = RiskCheckResult::VegaLimit;
+        } else if (contract == nullptr && (contract = find_contract(trade.contract_id, true)) == nullptr) {
+            result = RiskCheckResult::PositionBookFull;
+        } else if (!contract_underlying(*contract, trade.underlying)) {
+            result = RiskCheckResult::UnknownUnderlying; // Booked under another underlying meanwhile
+        } else {
+            slot.delta.store(delta + trade.delta, std::memory_order_relaxed);
+            slot.vega.store(vega + trade.vega, std::memory_order_relaxed);
+
+            ContractPosition& position = contract->position;
+            position.underlying = trade.underlying;
+            position.quantity += trade.quantity;
+            position.delta += trade.delta;
+            position.vega += trade.vega;
+            position.capital += trade.capital;
+            position.max_loss += trade.max_loss;
+        }
+    }
+
+    if (result != RiskCheckResult::Accepted) {
+        add(reserved_loss_, -loss_increase);
+        add(used_capital_, -capital_increase);
+        return result;
+    }
+
+    if (trade.capital < 0.0) add(used_capital_, trade.capital);
+    if (trade.max_loss < 0.0) add(reserved_loss_, trade.max_loss);
+    add(slot.capital, trade.capital);
+    return RiskCheckResult::Accepted;
+}
+
+void RiskEngine::release(const TradeRequest& trade) {
+    ContractSlot* contract = find_contract(trade.contract_id, false);
+    if (trade.underlying >= underlying_count_ || contract == nullptr ||
+        contract->underlying.load(std::memory_order_acquire) != trade.underlying) {
+        std::cerr << "Warning: Release for unknown contract " << trade.contract_id << " on underlying "
+                  << trade.underlying << " ignored." << std::endl;
+        return;
+    }
+    UnderlyingSlot& slot = underlyings_[trade.underlying];
+    {
+        SpinLock guard(slot.lock);
+        slot.delta.store(slot.delta.load(std::memory_order_relaxed) - trade.delta, std::memory_order_relaxed);
+        slot.vega.store(slot.vega.load(std::memory_order_relaxed) - trade.vega, std::memory_order_relaxed);
+
+        ContractPosition& position = contract->position;
+        position.quantity -= trade.quantity;
+        position.delta -= trade.delta;
+        position.vega -= trade.vega;
+        position.capital -= trade.capital;
+        position.max_loss -= trade.max_loss;
+    }
+    add(slot.capital, -trade.capital);
+    add(reserved_loss_, -trade.max_loss);
+    add(used_capital_, -trade.capital);
+}
+
+ContractPosition RiskEngine::close_position(std::uint64_t contract_id) {
+    ContractSlot* contract = find_contract(contract_id, false);
+    if (contract == nullptr) return {};
+    std::size_t underlying = contract->underlying.load(std::memory_order_acquire);
+    if (underlying == NO_UNDERLYING) return {}; // Being inserted; nothing booked yet
+
+    UnderlyingSlot& slot = underlyings_[underlying];
+    ContractPosition closed;
+    {
+        SpinLock guard(slot.lock);
+        closed = contract->position;
+        contract->position = ContractPosition{underlying};
+        slot.delta.store(slot.delta.load(std::memory_order_relaxed) - closed.delta, std::memory_order_relaxed);
+        slot.vega.store(slot.vega.load(std::memory_order_relaxed) - closed.vega, std::memory_order_relaxed);
+    }
+    add(slot.capital, -closed.capital);
+    add(reserved_loss_, -closed.max_loss);
+    add(used_capital_, -closed.capital);
+    return closed;
+}
+
+ContractPosition RiskEngine::position(std::uint64_t contract_id) const {
+    ContractSlot* contract = find_contract(contract_id, false);
+    if (contract == nullptr) return {};
+    std::size_t underlying = contract->underlying.load(std::memory_order_acquire);
+    if (underlying == NO_UNDERLYING) return {};
+
+    SpinLock guard(underlyings_[underlying].lock);
+    return contract->position;
+}
+
+void RiskEngine::record_pnl(double pnl) {
+    add(realized_pnl_, pnl);
+}
+
+UnderlyingExposure RiskEngine::exposure(std::size_t underlying) const {
+    if (underlying >= underlying_count_) return {};
+    const UnderlyingSlot& slot = underlyings_[underlying];
+    return UnderlyingExposure{slot.delta.load(std::memory_order_relaxed), slot.vega.load(std::memory_order_relaxed),
+                              slot.capital.load(std::memory_order_relaxed)};
+}
@@ -41,3 +41,79 @@ double calculate_historical_volatility(const std::vector<double>& prices, int pe
     // Annualize the volatility
     return daily_std_dev * std::sqrt(static_cast<double>(period));
 }
+
+RollingVolatility::RollingVolatility(std::size_t window, int period)
+    : window_(window), period_(period) {
+    ring_.reserve(window_);
+}
+
+void RollingVolatility::add_price(double price) {
+    if (last_price_ > 0) { // Same rule as calculate_historical_volatility: skip returns off a non-positive price
+        double value = std::log(price / last_price_);
+        if (window_ > 0 && ring_.size() == window_) {
+            remove_return(ring_[ring_head_]);
+            ring_[ring_head_] = value;
+            ring_head_ = (ring_head_ + 1) % window_;
+        } else if (window_ > 0) {
+            ring_.push_back(value);
+        }
+        add_return(value);
+    }
+    last_price_ = price;
+}
+
+void RollingVolatility::add_return(double value) {
+    ++count_;
+    double delta = value - mean_;
+    mean_ += delta / static_cast<double>(count_);
+    sum_sq_diff_ += delta * (value - mean_);
+}
+
+void RollingVolatility::remove_return(double value) {
+    if (count_ <= 1) {
+        count_ = 0;
+        mean_ = 0.0;
+        sum_sq_diff_ = 0.0;
+        return;
+    }
+    --count_;
+    double delta = value - mean_;
+    mean_ -= delta / static_cast<double>(count_);
+    sum_sq_diff_ -= delta * (value - mean_);
+    if (sum_sq_diff_ < 0.0) sum_sq_diff_ = 0.0; // Rounding
+}
+
+double RollingVolatility::volatility() const {
+    if (count_ < 2) {
+        return 0.0;
+    }
+    double variance = sum_sq_diff_ / static_cast<double>(count_ - 1);
+    return std::sqrt(variance) * std::sqrt(static_cast<double>(period_));
+}
+
+RollingVolatility::State RollingVolatility::state() const {
+    State state;
+    state.window = window_;
+    state.period = period_;
+    state.last_price = last_price_;
+    state.count = count_;
+    state.mean = mean_;
+    state.sum_sq_diff = sum_sq_diff_;
+    state.returns.reserve(ring_.size());
+    for (std::size_t i = 0; i < ring_.size(); ++i) {
+        state.returns.push_back(ring_[(ring_head_ + i) % ring_.size()]);
+    }
+    return state;
+}
+
+void RollingVolatility::restore(const State& state) {
+    window_ = static_cast<std::size_t>(state.window);
+    period_ = state.period;
+    last_price_ = state.last_price;
+    count_ = state.count;
+    mean_ = state.mean;
+    sum_sq_diff_ = state.sum_sq_diff;
+    ring_ = state.returns;
+    ring_.reserve(window_);
+    ring_head_ = 0;
+}
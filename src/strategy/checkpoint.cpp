@@ -0,0 +1,257 @@
+#include "strategy/checkpoint.h"
+#include <algorithm>    // For std::equal
+#include <cstdio>       // For std::rename, std::remove
+#include <cstring>      // For std::memcpy
+#include <fstream>      // For binary checkpoint files
+#include <iostream>     // For error messages
+#include <iterator>     // For std::istreambuf_iterator
+#include <type_traits>  // For std::is_trivially_copyable_v
+#include <vector>       // For std::vector
+
+namespace checkpoint {
+
+    namespace {
+
+        constexpr char CHECKPOINT_MAGIC[4] = {'V', 'T', 'C', 'K'};
+        constexpr std::uint32_t CHECKPOINT_VERSION = 2;
+        constexpr std::size_t HEADER_SIZE = sizeof(CHECKPOINT_MAGIC) + sizeof(std::uint32_t) +
+                                            2 * sizeof(std::uint64_t); // magic, version, payload size, checksum
+
+        // FNV-1a, enough to detect torn or damaged files.
+        std::uint64_t checksum(const char* data, std::size_t size) {
+            std::uint64_t hash = 0xcbf29ce484222325ull;
+            for (std::size_t i = 0; i < size; ++i) {
+                hash ^= static_cast<unsigned char>(data[i]);
+                hash *= 0x100000001b3ull;
+            }
+            return hash;
+        }
+
+        template <typename T>
+        void put(std::vector<char>& buffer, const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            std::size_t end = buffer.size();
+            buffer.resize(end + sizeof(T));
+            std::memcpy(buffer.data() + end, &value, sizeof(T));
+        }
+
+        // Sequential reader over the payload that fails once it runs out of bytes.
+        class PayloadReader {
+        public:
+            PayloadReader(const char* data, std::size_t size) : data_(data), size_(size) {}
+
+            template <typename T>
+            bool get(T& value) {
+                static_assert(std::is_trivially_copyable_v<T>);
+                if (size_ - position_ < sizeof(T)) return false;
+                std::memcpy(&value, data_ + position_, sizeof(T));
+                position_ += sizeof(T);
+                return true;
+            }
+
+            // Reads a count and rejects values that cannot fit in the rest of the payload.
+            bool get_count(std::size_t element_size, std::uint64_t& count) {
+                return get(count) && count <= (size_ - position_) / element_size;
+            }
+
+            bool at_end() const { return position_ == size_; }
+
+        private:
+            const char* data_;
+            std::size_t size_;
+            std::size_t position_{0};
+        };
+
+        void encode(const Checkpoint& checkpoint, std::vector<char>& payload) {
+            const StrategyState& strategy = checkpoint.strategy;
+            const RollingVolatility::State& rv = strategy.realized_vol;
+
+            put(payload, checkpoint.source_offset);
+            put(payload, checkpoint.source_fingerprint);
+            put(payload, strategy.events_applied);
+
+            put(payload, rv.window);
+            put(payload, static_cast<std::int32_t>(rv.period));
+            put(payload, rv.last_price);
+            put(payload, rv.count);
+            put(payload, rv.mean);
+            put(payload, rv.sum_sq_diff);
+            put(payload, static_cast<std::uint64_t>(rv.returns.size()));
+            for (double value : rv.returns) put(payload, value);
+
+            put(payload, static_cast<std::uint8_t>(strategy.surface.has_value()));
+            HestonParameters surface = strategy.surface.value_or(HestonParameters{});
+            put(payload, surface.initial_variance);
+            put(payload, surface.long_run_variance);
+            put(payload, surface.correlation);
+            put(payload, surface.mean_reversion);
+            put(payload, surface.vol_of_vol);
+
+            put(payload, static_cast<std::uint64_t>(strategy.contracts.size()));
+            for (const ContractState& contract : strategy.contracts) {
+                put(payload, contract.contract_id);
+                put(payload, contract.last_implied_vol);
+                put(payload, contract.position);
+                put(payload, contract.average_price);
+            }
+        }
+
+        bool decode(PayloadReader& in, Checkpoint& checkpoint) {
+            StrategyState& strategy = checkpoint.strategy;
+            RollingVolatility::State& rv = strategy.realized_vol;
+
+            std::int32_t period = 0;
+            std::uint64_t count = 0;
+            bool ok = in.get(checkpoint.source_offset) && in.get(checkpoint.source_fingerprint) &&
+                      in.get(strategy.events_applied) &&
+                      in.get(rv.window) && in.get(period) && in.get(rv.last_price) &&
+                      in.get(rv.count) && in.get(rv.mean) && in.get(rv.sum_sq_diff) &&
+                      in.get_count(sizeof(double), count) && count <= rv.window;
+            // A windowed estimator holds exactly its `count` returns; an expanding one keeps none
+            if (!ok || count != (rv.window > 0 ? rv.count : 0)) return false;
+            rv.period = period;
+            rv.returns.resize(count);
+            for (double& value : rv.returns) {
+                if (!in.get(value)) return false;
+            }
+
+            std::uint8_t has_surface = 0;
+            HestonParameters surface;
+            ok = in.get(has_surface) && in.get(surface.initial_variance) && in.get(surface.long_run_variance) &&
+                 in.get(surface.correlation) && in.get(surface.mean_reversion) && in.get(surface.vol_of_vol) &&
+                 in.get_count(sizeof(std::uint64_t) + 3 * sizeof(double), count);
+            if (!ok) return false;
+            if (has_surface) strategy.surface = surface;
+
+            strategy.contracts.resize(count);
+            for (ContractState& contract : strategy.contracts) {
+                if (!(in.get(contract.contract_id) && in.get(contract.last_implied_vol) &&
+                      in.get(contract.position) && in.get(contract.average_price))) {
+                    return false;
+                }
+            }
+            return in.at_end();
+        }
+
+    } // namespace
+
+    bool write_checkpoint(const std::string& filepath, const Checkpoint& checkpoint) {
+        std::vector<char> payload;
+        encode(checkpoint, payload);
+
+        std::vector<char> header;
+        header.insert(header.end(), CHECKPOINT_MAGIC, CHECKPOINT_MAGIC + sizeof(CHECKPOINT_MAGIC));
+        put(header, CHECKPOINT_VERSION);
+        put(header, static_cast<std::uint64_t>(payload.size()));
+        put(header, checksum(payload.data(), payload.size()));
+
+        const std::string temp_path = filepath + ".tmp";
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                std::cerr << "Error: Could not create checkpoint file: " << temp_path << std::endl;
+                return false;
+            }
+            out.write(header.data(), static_cast<std::streamsize>(header.size()));
+            out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+            out.flush();
+            if (!out.good()) {
+                std::cerr << "Error: Failed to write checkpoint file: " << temp_path << std::endl;
+                return false;
+            }
+        }
+
+        if (std::rename(temp_path.c_str(), filepath.c_str()) != 0) {
+            std::cerr << "Error: Could not move checkpoint into place: " << filepath << std::endl;
+            std::remove(temp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    std::optional<Checkpoint> read_checkpoint(const std::string& filepath) {
+        std::ifstream in(filepath, std::ios::binary);
+        if (!in.is_open()) {
+            return std::nullopt; // No checkpoint yet
+        }
+        std::vector<char> contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        PayloadReader header(contents.data(), contents.size());
+        std::uint32_t version = 0;
+        std::uint64_t payload_size = 0;
+        std::uint64_t expected_checksum = 0;
+        char magic[sizeof(CHECKPOINT_MAGIC)];
+        bool ok = header.get(magic) && std::equal(magic, magic + sizeof(magic), CHECKPOINT_MAGIC) &&
+                  header.get(version) && version == CHECKPOINT_VERSION &&
+                  header.get(payload_size) && header.get(expected_checksum) &&
+                  payload_size == contents.size() - HEADER_SIZE &&
+                  checksum(contents.data() + HEADER_SIZE, payload_size) == expected_checksum;
+
+        Checkpoint checkpoint;
+        if (ok) {
+            PayloadReader payload(contents.data() + HEADER_SIZE, payload_size);
+            ok = decode(payload, checkpoint);
+        }
+        if (!ok) {
+            std::cerr << "Error: Invalid or corrupt checkpoint file: " << filepath << std::endl;
+            return std::nullopt;
+        }
+        return checkpoint;
+    }
+
+    CheckpointWriter::CheckpointWriter(std::string filepath)
+        : filepath_(std::move(filepath)), thread_(&CheckpointWriter::run, this) {}
+
+    CheckpointWriter::~CheckpointWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        work_ready_.notify_one();
+        thread_.join();
+    }
+
+    void CheckpointWriter::submit(Checkpoint checkpoint) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = std::move(checkpoint);
+        }
+        work_ready_.notify_one();
+    }
+
+    void CheckpointWriter::flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_done_.wait(lock, [this] { return !pending_ && !writing_; });
+    }
+
+    std::uint64_t CheckpointWriter::written_count() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return written_count_;
+    }
+
+    std::uint64_t CheckpointWriter::failed_count() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return failed_count_;
+    }
+
+    void CheckpointWriter::run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            work_ready_.wait(lock, [this] { return pending_ || stopping_; });
+            if (!pending_) break; // Stopping with nothing left to write
+
+            Checkpoint checkpoint = std::move(*pending_);
+            pending_.reset();
+            writing_ = true;
+            lock.unlock();
+
+            bool ok = write_checkpoint(filepath_, checkpoint);
+
+            lock.lock();
+            writing_ = false;
+            ++(ok ? written_count_ : failed_count_);
+            work_done_.notify_all();
+        }
+    }
+
+} // namespace checkpoint
@@ -4,21 +4,79 @@
 
 #include <iostream> // For std::cout, std::endl
 #include <iomanip>  // For std::fixed, std::setprecision
+#include <cmath>    // For std::abs
+#include <limits>   // For std::numeric_limits
+
+ImpliedVolStrategy::ImpliedVolStrategy(std::size_t rv_window)
+    : realized_vol_(rv_window) {}
 
 void ImpliedVolStrategy::analyze(const OptionData& option, const MarketData& market,
                                  const std::vector<double>& historical_prices) {
 
     // 1. Calculate Implied Volatility (IV)
-    double implied_vol = implied_volatility_bisection(option, market);
-    std::cout << "  Calculated Implied Volatility (IV): " << std::fixed << std::setprecision(4) << implied_vol * 100 << "%" << std::endl;
+    ExpiryFactors factors = make_expiry_factors(market, option.time_to_expiration);
+    double implied_vol = implied_volatility_bisection(option, factors);
 
     // 2. Forecast Realized Volatility (RV) using historical data
     double forecasted_realized_vol = calculate_historical_volatility(historical_prices);
-    std::cout << "  Forecasted Realized Volatility (RV): " << std::fixed << std::setprecision(4) << forecasted_realized_vol * 100 << "%" << std::endl;
+    report(option, factors, implied_vol, forecasted_realized_vol);
+}
+
+void ImpliedVolStrategy::on_price(double price) {
+    realized_vol_.add_price(price);
+    ++events_applied_;
+}
+
+void ImpliedVolStrategy::analyze(std::uint64_t contract_id, const OptionData& option, const ExpiryFactors& factors) {
+    double implied_vol = implied_volatility_bisection(option, factors);
+
+    ContractState& contract = contracts_[contract_id];
+    contract.contract_id = contract_id;
+    contract.last_implied_vol = implied_vol;
+
+    report(option, factors, implied_vol, realized_vol_.volatility());
+}
+
+void ImpliedVolStrategy::record_fill(std::uint64_t contract_id, double quantity, double price) {
+    ContractState& contract = contracts_[contract_id];
+    contract.contract_id = contract_id;
+    double new_position = contract.position + quantity;
+    if (contract.position == 0.0 || (contract.position > 0.0) != (new_position > 0.0) || new_position == 0.0) {
+        // Opening, flipping or closing: the remaining position was entered at this fill
+        contract.average_price = new_position != 0.0 ? price : 0.0;
+    } else if (std::abs(new_position) > std::abs(contract.position)) {
+        // Adding to the position
+        contract.average_price = (contract.average_price * contract.position + price * quantity) / new_position;
+    }
+    contract.position = new_position;
+}
+
+StrategyState ImpliedVolStrategy::state() const {
+    StrategyState state;
+    state.events_applied = events_applied_;
+    state.realized_vol = realized_vol_.state();
+    state.surface = surface_;
+    state.contracts.reserve(contracts_.size());
+    for (const auto& entry : contracts_) {
+        state.contracts.push_back(entry.second);
+    }
+    return state;
+}
 
+void ImpliedVolStrategy::restore(const StrategyState& state) {
+    events_applied_ = state.events_applied;
+    realized_vol_.restore(state.realized_vol);
+    surface_ = state.surface;
+    contracts_.clear();
+    for (const ContractState& contract : state.contracts) {
+        contracts_[contract.contract_id] = contract;
+    }
+}
+
+void ImpliedVolStrategy::report(const OptionData& option, const ExpiryFactors& factors,
+                                double implied_vol, double forecasted_realized_vol) {
     // 3. Identify Discrepancies and Generate Signal
     double discrepancy = implied_vol - forecasted_realized_vol;
-    std::cout << "  IV - RV Discrepancy: " << std::fixed << std::setprecision(4) << discrepancy * 100 << "%" << std::endl;
 
     // Define thresholds for trading signals (these would be optimized in practice)
     // A negative discrepancy means IV < RV (undervalued IV, potential long vol)
@@ -26,9 +84,46 @@ void ImpliedVolStrategy::analyze(const OptionData& option, const MarketData& mar
     const double LONG_VOL_THRESHOLD = -0.05; // If IV is 5% points below RV
     const double SHORT_VOL_THRESHOLD = 0.05; // If IV is 5% points above RV
 
+    VolatilitySignal signal = VolatilitySignal::Neutral;
     if (discrepancy < LONG_VOL_THRESHOLD) {
-        std::cout << "  SIGNAL: BUY VOLATILITY (e.g., Long Straddle/Strangle) - IV is significantly undervalued." << std::endl;
+        signal = VolatilitySignal::Buy;
     } else if (discrepancy > SHORT_VOL_THRESHOLD) {
+        signal = VolatilitySignal::Sell;
+    }
+
+    if (analytics_writer_ != nullptr) {
+        analytics_output::AnalyticsRow row;
+        row.timestamp = timestamp_;
+        row.strike_price = option.strike_price;
+        row.time_to_expiration = option.time_to_expiration;
+        row.type = option.type;
+        row.market_price = option.market_price;
+        row.implied_vol = implied_vol;
+        row.realized_vol = forecasted_realized_vol;
+        row.discrepancy = discrepancy;
+        row.signal = signal;
+        row.delta = row.vega = row.theta = row.rho = std::numeric_limits<double>::quiet_NaN();
+        if (analytics_greeks_ && implied_vol > 0.0) { // Greeks at the implied volatility; none if the solver failed
+            BlackScholesSensitivities greeks = black_scholes_sensitivities(factors, option.strike_price,
+                                                                           implied_vol, option.type);
+            row.delta = greeks.delta;
+            row.vega = greeks.vega;
+            row.theta = -greeks.theta; // Calendar-time decay
+            row.rho = greeks.rho;
+        }
+        analytics_writer_->append(row);
+    }
+
+    if (!verbose_) {
+        return;
+    }
+    std::cout << "  Calculated Implied Volatility (IV): " << std::fixed << std::setprecision(4) << implied_vol * 100 << "%" << std::endl;
+    std::cout << "  Forecasted Realized Volatility (RV): " << std::fixed << std::setprecision(4) << forecasted_realized_vol * 100 << "%" << std::endl;
+    std::cout << "  IV - RV Discrepancy: " << std::fixed << std::setprecision(4) << discrepancy * 100 << "%" << std::endl;
+
+    if (signal == VolatilitySignal::Buy) {
+        std::cout << "  SIGNAL: BUY VOLATILITY (e.g., Long Straddle/Strangle) - IV is significantly undervalued." << std::endl;
+    } else if (signal == VolatilitySignal::Sell) {
         std::cout << "  SIGNAL: SELL VOLATILITY (e.g., Short Straddle/Strangle) - IV is significantly overvalued." << std::endl;
     } else {
         std::cout << "  SIGNAL: NEUTRAL - IV is generally in line with forecasted RV." << std::endl;
@@ -0,0 +1,109 @@
+#include "utils/adjoint.h"
+
+#include <atomic>    // For std::atomic
+#include <stdexcept> // For std::logic_error
+#include <string>    // For std::to_string
+
+namespace adjoint {
+
+    namespace {
+        thread_local Tape* active_tape = nullptr;
+        std::atomic<std::uint32_t> last_tape_id{NO_TAPE};
+
+        std::uint32_t next_tape_id() {
+            std::uint32_t id = last_tape_id.fetch_add(1, std::memory_order_relaxed) + 1;
+            return id == NO_TAPE ? next_tape_id() : id; // Skip NO_TAPE on wrap-around
+        }
+    }
+
+    Tape::Tape() : id_(next_tape_id()) {}
+
+    Tape::~Tape() {
+        deactivate();
+    }
+
+    void Tape::activate() {
+        active_tape = this;
+    }
+
+    void Tape::deactivate() {
+        if (active_tape == this) {
+            active_tape = nullptr;
+        }
+    }
+
+    Tape* Tape::active() {
+        return active_tape;
+    }
+
+    Tape& Tape::recording(std::uint32_t tape_id) {
+        if (active_tape == nullptr) {
+            throw std::logic_error("Adjoint operation on a tape input with no tape active.");
+        }
+        if (tape_id == NO_TAPE) {
+            throw std::logic_error("Adjoint operation combines inputs of different tapes.");
+        }
+        if (tape_id != active_tape->id_) {
+            throw std::logic_error("Adjoint operation on an input of tape " + std::to_string(tape_id) +
+                                   " while tape " + std::to_string(active_tape->id_) +
+                                   " is active (another tape, or this one since rewound).");
+        }
+        return *active_tape;
+    }
+
+    Real Tape::input(double value) {
+        Real result(value);
+        result.node_ = record(NO_NODE, 0.0);
+        result.tape_ = id_;
+        return result;
+    }
+
+    std::uint32_t Tape::record(std::uint32_t parent0, double partial0,
+                               std::uint32_t parent1, double partial1) {
+        if ((size_ >> BLOCK_SHIFT) == blocks_.size()) {
+            blocks_.push_back(std::make_unique<Node[]>(BLOCK_NODES));
+        }
+        Node& entry = node(size_);
+        entry.parent[0] = parent0;
+        entry.parent[1] = parent1;
+        entry.partial[0] = partial0;
+        entry.partial[1] = partial1;
+        return static_cast<std::uint32_t>(size_++);
+    }
+
+    void Tape::propagate(const Real& output) {
+        adjoints_.assign(size_, 0.0);
+        if (output.node_ == NO_NODE) {
+            return; // Output does not depend on any input
+        }
+        if (output.tape_ != id_) {
+            throw std::logic_error("Adjoint propagation of an output recorded on another tape (or before a rewind).");
+        }
+
+        adjoints_[output.node_] = 1.0;
+        // Nodes are recorded in evaluation order, so a reverse scan visits every
+        // node after all of the nodes that use it.
+        for (std::size_t i = output.node_ + 1; i-- > 0;) {
+            double adjoint_value = adjoints_[i];
+            if (adjoint_value == 0.0) continue;
+            const Node& entry = node(i);
+            if (entry.parent[0] != NO_NODE) adjoints_[entry.parent[0]] += adjoint_value * entry.partial[0];
+            if (entry.parent[1] != NO_NODE) adjoints_[entry.parent[1]] += adjoint_value * entry.partial[1];
+        }
+    }
+
+    double Tape::adjoint(const Real& x) const {
+        if (x.node_ == NO_NODE) return 0.0;
+        if (x.tape_ != id_) {
+            throw std::logic_error("Adjoint requested for an input recorded on another tape (or before a rewind).");
+        }
+        return x.node_ < adjoints_.size() ? adjoints_[x.node_] : 0.0;
+    }
+
+    void Tape::rewind() {
+        size_ = 0;
+        adjoints_.clear();
+        id_ = next_tape_id();
+    }
+
+} // namespace adjoint
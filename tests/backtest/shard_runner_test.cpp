@@ -0,0 +1,141 @@
+// Runs a synthetic backtest through the forked shard runner and checks that the
+// merged result does not depend on the order in which shard results arrive, and
+// that the runner leaves the caller's other child processes alone.
+//
+// Usage: shard_runner_test [max_workers]
+
+#include <algorithm>  // For std::shuffle
+#include <chrono>     // For std::chrono::milliseconds
+#include <cstdlib>    // For std::atoi, mkdtemp
+#include <filesystem> // For std::filesystem::remove_all
+#include <iostream>   // For std::cout, std::cerr
+#include <optional>   // For std::optional
+#include <random>     // For std::mt19937
+#include <string>     // For std::string
+#include <thread>     // For std::this_thread::sleep_for
+#include <vector>     // For std::vector
+
+#include <sys/wait.h> // For waitpid
+#include <unistd.h>   // For fork, _exit
+
+#include "backtest/shard_runner.h"
+
+namespace {
+    int failures = 0;
+
+    void expect(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAIL: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    // Deterministic synthetic shard: a few trades and marks derived from the spec.
+    // With a delay, later shards sleep less, so workers finish roughly in reverse order.
+    bool synthetic_worker(const backtest::ShardSpec& spec, backtest::ShardResult& result, std::size_t shard_count) {
+        if (spec.index < shard_count) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2 * (shard_count - spec.index)));
+        }
+
+        std::mt19937 rng(spec.index * 7919u + static_cast<unsigned>(spec.symbol.size()));
+        std::uniform_real_distribution<double> move(-1.0, 1.0);
+        std::int64_t length = spec.last_timestamp - spec.first_timestamp + 1;
+        for (std::int64_t step = 0; step < 5; ++step) {
+            std::int64_t timestamp = spec.first_timestamp + step * length / 5;
+            result.pnl.push_back(backtest::PnlPoint{timestamp, 100.0 * move(rng)});
+        }
+        for (std::uint64_t contract = 0; contract < 3; ++contract) {
+            result.contracts.push_back(backtest::ContractActivity{
+                contract, static_cast<double>(static_cast<int>(rng() % 5) - 2), 10.0 + move(rng)});
+        }
+        result.trade_count = rng() % 10;
+        result.rows_processed = static_cast<std::uint64_t>(length);
+        return true;
+    }
+
+    bool same_result(const backtest::MergedResult& a, const backtest::MergedResult& b) {
+        if (a.pnl.size() != b.pnl.size() || a.positions.size() != b.positions.size()) return false;
+        for (std::size_t i = 0; i < a.pnl.size(); ++i) {
+            // Exact comparison: the merge must sum in the same order every time
+            if (a.pnl[i].timestamp != b.pnl[i].timestamp || a.pnl[i].pnl != b.pnl[i].pnl) return false;
+        }
+        for (std::size_t i = 0; i < a.positions.size(); ++i) {
+            const backtest::MergedPosition& x = a.positions[i];
+            const backtest::MergedPosition& y = b.positions[i];
+            if (x.symbol != y.symbol || x.contract_id != y.contract_id ||
+                x.quantity != y.quantity || x.last_mark != y.last_mark) return false;
+        }
+        return a.total_pnl == b.total_pnl && a.max_drawdown == b.max_drawdown &&
+               a.trade_count == b.trade_count && a.rows_processed == b.rows_processed &&
+               a.shard_count == b.shard_count;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    unsigned max_workers = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 8;
+
+    std::vector<backtest::ShardSpec> shards = backtest::make_shards({"SPX", "NDX", "RUT"}, 0, 999, 100);
+    backtest::ShardWorker worker = [&](const backtest::ShardSpec& spec, backtest::ShardResult& result) {
+        return synthetic_worker(spec, result, shards.size());
+    };
+
+    char directory_template[] = "/tmp/shard_runner_test_XXXXXX";
+    if (mkdtemp(directory_template) == nullptr) {
+        std::cerr << "Error: Could not create a temporary directory." << std::endl;
+        return 2;
+    }
+    const std::string directory = directory_template;
+
+    // A child of the caller that exits while the workers run must not be reaped by the runner.
+    pid_t bystander = fork();
+    if (bystander == 0) {
+        _exit(7);
+    }
+
+    bool ran = backtest::run_local_shards(shards, worker, directory, max_workers);
+    expect(ran, "all shard workers succeed");
+
+    int status = 0;
+    expect(bystander > 0 && waitpid(bystander, &status, 0) == bystander &&
+               WIFEXITED(status) && WEXITSTATUS(status) == 7,
+           "caller's own child is still there to be reaped");
+
+    std::optional<backtest::MergedResult> from_files = backtest::merge_shard_files(shards, directory);
+    expect(from_files.has_value(), "merge of the workers' result files");
+
+    // The same shards computed in-process, merged in many arrival orders.
+    std::vector<backtest::ShardResult> results;
+    for (const backtest::ShardSpec& spec : shards) {
+        backtest::ShardResult result;
+        result.spec = spec;
+        synthetic_worker(spec, result, 0); // No delay
+        results.push_back(result);
+    }
+    std::optional<backtest::MergedResult> reference = backtest::merge_shard_results(results);
+    expect(reference.has_value(), "in-process merge");
+    if (reference.has_value() && from_files.has_value()) {
+        expect(same_result(*reference, *from_files), "forked run matches in-process run");
+    }
+
+    std::mt19937 rng(12345);
+    const int permutations = 200;
+    for (int i = 0; i < permutations && reference.has_value(); ++i) {
+        std::shuffle(results.begin(), results.end(), rng);
+        std::optional<backtest::MergedResult> merged = backtest::merge_shard_results(results);
+        expect(merged.has_value() && same_result(*reference, *merged),
+               "merge of permutation " + std::to_string(i) + " matches");
+    }
+
+    results.push_back(results.front());
+    expect(!backtest::merge_shard_results(results).has_value(), "duplicate shard is rejected");
+
+    std::filesystem::remove_all(directory);
+
+    std::cout << "Shards: " << shards.size() << ", workers: " << max_workers << ", permutations: " << permutations;
+    if (reference.has_value()) {
+        std::cout << ", total P&L: " << reference->total_pnl << ", open positions: " << reference->positions.size();
+    }
+    std::cout << std::endl;
+    std::cout << (failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+// Writes analytics rows through the double-buffered AnalyticsWriter and reads
+// them back through the memory-mapped AnalyticsReader: row counts that end
+// exactly on a block boundary, just past one and many blocks long (so the
+// filling and writing buffers swap many times), a file with no rows, and
+// rejection of zero-length and truncated files.
+//
+// Usage: analytics_output_test
+
+#include <cmath>      // For std::isnan
+#include <cstdlib>    // For mkdtemp
+#include <filesystem> // For std::filesystem::remove_all, std::filesystem::resize_file
+#include <iostream>   // For std::cout, std::cerr
+#include <limits>     // For std::numeric_limits
+#include <string>     // For std::string
+#include <vector>     // For std::vector
+
+#include "data/analytics_output.h"
+
+namespace {
+    using namespace analytics_output;
+
+    constexpr std::uint32_t BLOCK_ROWS = 8;
+
+    int failures = 0;
+
+    void expect(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAIL: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    // Distinct values in every column; every third row has no Greeks (NaN).
+    AnalyticsRow make_row(std::uint64_t i) {
+        AnalyticsRow row;
+        double x = static_cast<double>(i);
+        row.timestamp = 1700000000000 + static_cast<std::int64_t>(i) * 250;
+        row.strike_price = 80.0 + 0.5 * x;
+        row.time_to_expiration = 0.01 * static_cast<double>(i % 97 + 1);
+        row.type = i % 2 == 0 ? OptionType::Call : OptionType::Put;
+        row.market_price = 1.0 + 0.125 * x;
+        row.implied_vol = 0.15 + 1e-4 * x;
+        row.realized_vol = 0.2 - 1e-5 * x;
+        row.discrepancy = row.implied_vol - row.realized_vol;
+        row.signal = i % 3 == 0 ? VolatilitySignal::Buy : i % 3 == 1 ? VolatilitySignal::Sell : VolatilitySignal::Neutral;
+        double nan = std::numeric_limits<double>::quiet_NaN();
+        row.delta = i % 3 == 2 ? nan : 0.5 - 1e-3 * x;
+        row.vega = i % 3 == 2 ? nan : 20.0 + x;
+        row.theta = i % 3 == 2 ? nan : -5.0 - x;
+        row.rho = i % 3 == 2 ? nan : 10.0 + 0.25 * x;
+        return row;
+    }
+
+    bool same_double(double a, double b) {
+        return (std::isnan(a) && std::isnan(b)) || a == b;
+    }
+
+    // Writes `rows` rows and checks every value read back through the mapped file.
+    void check_round_trip(const std::string& path, std::uint64_t rows) {
+        const std::string label = std::to_string(rows) + " rows: ";
+        {
+            AnalyticsWriter writer(BLOCK_ROWS);
+            expect(writer.open(path), label + "writer opens");
+            for (std::uint64_t i = 0; i < rows; ++i) expect(writer.append(make_row(i)), label + "append");
+            expect(writer.row_count() == rows, label + "writer row count");
+            expect(writer.close(), label + "writer closes");
+            expect(!writer.append(make_row(0)), label + "append after close fails");
+        }
+
+        AnalyticsReader reader;
+        if (!reader.open(path)) {
+            expect(false, label + "reader opens");
+            return;
+        }
+        const std::size_t expected_blocks = static_cast<std::size_t>((rows + BLOCK_ROWS - 1) / BLOCK_ROWS);
+        expect(reader.row_count() == rows, label + "reader row count");
+        expect(reader.block_count() == expected_blocks, label + "block count");
+
+        std::uint64_t i = 0;
+        std::uint64_t mismatches = 0;
+        for (std::size_t b = 0; b < reader.block_count(); ++b) {
+            AnalyticsBlock block = reader.block(b);
+            std::size_t expected_size = b + 1 < expected_blocks || rows % BLOCK_ROWS == 0 ? BLOCK_ROWS : rows % BLOCK_ROWS;
+            expect(block.size() == expected_size, label + "size of block " + std::to_string(b));
+            expect(reinterpret_cast<std::uintptr_t>(block.strike_price.data()) % alignof(double) == 0,
+                   label + "columns are aligned");
+            for (std::size_t r = 0; r < block.size(); ++r, ++i) {
+                AnalyticsRow row = make_row(i);
+                bool same = block.timestamp[r] == row.timestamp && block.strike_price[r] == row.strike_price &&
+                            block.time_to_expiration[r] == row.time_to_expiration &&
+                            block.type[r] == static_cast<char>(row.type) && block.market_price[r] == row.market_price &&
+                            block.implied_vol[r] == row.implied_vol && block.realized_vol[r] == row.realized_vol &&
+                            block.discrepancy[r] == row.discrepancy && block.signal[r] == static_cast<char>(row.signal) &&
+                            same_double(block.delta[r], row.delta) && same_double(block.vega[r], row.vega) &&
+                            same_double(block.theta[r], row.theta) && same_double(block.rho[r], row.rho);
+                mismatches += same ? 0 : 1;
+            }
+        }
+        expect(i == rows, label + "rows visited");
+        expect(mismatches == 0, label + std::to_string(mismatches) + " rows differ");
+    }
+
+    void check_rejected_files(const std::string& directory) {
+        const std::string path = directory + "/truncated.vtan";
+        check_round_trip(path, 2 * BLOCK_ROWS + 3);
+        const std::uintmax_t full_size = std::filesystem::file_size(path);
+
+        // Every shorter length loses the trailer, the index or part of a block
+        std::uintmax_t accepted = 0;
+        for (std::uintmax_t size = full_size; size-- > 0;) {
+            std::filesystem::resize_file(path, size);
+            AnalyticsReader reader;
+            if (reader.open(path)) ++accepted;
+        }
+        expect(accepted == 0, std::to_string(accepted) + " truncated files were accepted");
+
+        AnalyticsReader reader;
+        expect(!reader.open(directory + "/missing.vtan"), "missing file is rejected");
+        std::cout << "Truncation: " << full_size << " shorter lengths rejected" << std::endl;
+    }
+}
+
+int main() {
+    char directory_template[] = "/tmp/analytics_output_test_XXXXXX";
+    if (mkdtemp(directory_template) == nullptr) {
+        std::cerr << "Error: Could not create a temporary directory." << std::endl;
+        return 2;
+    }
+    const std::string directory = directory_template;
+    const std::string path = directory + "/analytics.vtan";
+
+    // No rows, one row, exactly one and two blocks, one row past a block, many swaps
+    for (std::uint64_t rows : {std::uint64_t{0}, std::uint64_t{1}, std::uint64_t{BLOCK_ROWS},
+                               std::uint64_t{2 * BLOCK_ROWS}, std::uint64_t{2 * BLOCK_ROWS + 1},
+                               std::uint64_t{1000 * BLOCK_ROWS + 5}}) {
+        check_round_trip(path, rows);
+    }
+    std::cout << "Round trips checked with " << BLOCK_ROWS << "-row blocks" << std::endl;
+
+    check_rejected_files(directory);
+
+    std::filesystem::remove_all(directory);
+    std::cout << (failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+// Checks zero-rate interpolation on term structures: the front rate held flat
+// before the first tenor, r(t) * t linear between tenors (so forward rates are
+// flat on each interval), the back rate held flat past the last tenor, a
+// single-tenor curve constant everywhere, discount factors, rejection of
+// malformed curves, and that ExpiryFactors built from a MarketData match the
+// same flat rates given as curves.
+//
+// Usage: term_structure_test
+
+#include <algorithm> // For std::max
+#include <cmath>     // For std::abs, std::exp
+#include <iostream>  // For std::cout, std::cerr
+#include <stdexcept> // For std::invalid_argument
+#include <string>    // For std::string
+#include <utility>   // For std::move
+#include <vector>    // For std::vector
+
+#include "data/expiry_factors.h"
+#include "data/term_structure.h"
+
+namespace {
+    constexpr double TOLERANCE = 1e-14;
+
+    int failures = 0;
+
+    void expect(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAIL: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    bool near(double a, double b) {
+        return std::abs(a - b) <= TOLERANCE * std::max(1.0, std::abs(b));
+    }
+
+    // Forward rate over [t0, t1] implied by the curve's zero rates.
+    double forward_rate(const TermStructure& curve, double t0, double t1) {
+        return (curve.rate(t1) * t1 - curve.rate(t0) * t0) / (t1 - t0);
+    }
+
+    void check_interpolation() {
+        const TermStructure curve({0.25, 1.0, 2.0}, {0.01, 0.03, 0.02});
+
+        // Before the first tenor, including t = 0 and negative times
+        for (double t : {-1.0, 0.0, 1e-9, 0.1, 0.25}) {
+            expect(curve.rate(t) == 0.01, "front rate held flat at t = " + std::to_string(t));
+        }
+
+        // Between tenors r(t) * t is linear, e.g. halfway through [0.25, 1]
+        double expected = (0.5 * 0.01 * 0.25 + 0.5 * 0.03 * 1.0) / 0.625;
+        expect(near(curve.rate(0.625), expected), "zero rate halfway between the first two tenors");
+        expect(curve.rate(1.0) == 0.03, "zero rate at an inner tenor");
+
+        // Forward rates are flat on each interval and jump only at tenors
+        double first = (0.03 * 1.0 - 0.01 * 0.25) / 0.75;
+        double second = (0.02 * 2.0 - 0.03 * 1.0) / 1.0;
+        expect(near(forward_rate(curve, 0.3, 0.5), first) && near(forward_rate(curve, 0.6, 0.95), first),
+               "forward rate is flat on [0.25, 1]");
+        expect(near(forward_rate(curve, 1.1, 1.4), second) && near(forward_rate(curve, 1.5, 1.9), second),
+               "forward rate is flat on [1, 2]");
+
+        // Past the last tenor
+        for (double t : {2.0, 2.5, 30.0}) {
+            expect(curve.rate(t) == 0.02, "back rate held flat at t = " + std::to_string(t));
+        }
+
+        expect(near(curve.discount_factor(0.625), std::exp(-expected * 0.625)), "discount factor between tenors");
+        expect(curve.discount_factor(0.0) == 1.0, "discount factor at t = 0");
+    }
+
+    void check_single_tenor() {
+        const TermStructure single({0.5}, {0.04});
+        const TermStructure flat(0.04);
+        for (double t : {0.0, 0.1, 0.5, 0.75, 10.0}) {
+            expect(single.rate(t) == 0.04 && flat.rate(t) == 0.04,
+                   "single-tenor curve is constant at t = " + std::to_string(t));
+        }
+        expect(TermStructure().rate(3.0) == 0.0, "default curve is flat at 0%");
+    }
+
+    void check_invalid_curves() {
+        auto rejected = [](std::vector<double> tenors, std::vector<double> rates) {
+            try {
+                TermStructure curve(std::move(tenors), std::move(rates));
+            } catch (const std::invalid_argument&) {
+                return true;
+            }
+            return false;
+        };
+        expect(rejected({}, {}), "empty curve is rejected");
+        expect(rejected({1.0, 2.0}, {0.01}), "mismatched sizes are rejected");
+        expect(rejected({0.0, 1.0}, {0.01, 0.02}), "zero tenor is rejected");
+        expect(rejected({1.0, 1.0}, {0.01, 0.02}), "repeated tenor is rejected");
+        expect(rejected({2.0, 1.0}, {0.01, 0.02}), "decreasing tenors are rejected");
+    }
+
+    // MarketData goes through the curve overload as flat curves, so both agree exactly.
+    void check_expiry_factors() {
+        const MarketData market(100.0, 0.03, 0.01);
+        for (double t : {0.0, 0.1, 1.0, 5.0}) {
+            ExpiryFactors from_market = make_expiry_factors(market, t);
+            ExpiryFactors from_curves = make_expiry_factors(100.0, TermStructure(0.03), TermStructure(0.01), t);
+            expect(from_market.discount_factor == from_curves.discount_factor &&
+                       from_market.dividend_factor == from_curves.dividend_factor &&
+                       from_market.forward == from_curves.forward && from_market.rate == from_curves.rate &&
+                       from_market.dividend_yield == from_curves.dividend_yield &&
+                       from_market.sqrt_time == from_curves.sqrt_time,
+                   "MarketData and flat curves give the same factors at t = " + std::to_string(t));
+        }
+        ExpiryFactors factors = make_expiry_factors(market, 1.0);
+        expect(near(factors.forward, 100.0 * std::exp(0.02)) && near(factors.sqrt_time, 1.0),
+               "forward and sqrt(T) at one year");
+        expect(make_expiry_factors(market, 0.0).forward == 100.0, "forward is spot at expiry");
+    }
+}
+
+int main() {
+    check_interpolation();
+    check_single_tenor();
+    check_invalid_curves();
+    check_expiry_factors();
+
+    std::cout << (failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+// Round-trips chain snapshots through the tick archive and checks seeking:
+// exact values for decimal and arbitrary prices, ranges that start or end on
+// every block boundary (with snapshots larger than block_rows, so duplicate
+// timestamps straddle where a fixed-size block would have been cut), empty
+// ranges and an empty archive. Then reports size against CSV and decode speed
+// for an 800k-row synthetic history.
+//
+// Usage: tick_archive_test
+
+#include <algorithm>  // For std::min
+#include <charconv>   // For std::to_chars
+#include <chrono>     // For std::chrono::steady_clock
+#include <cmath>      // For std::round
+#include <cstdlib>    // For mkdtemp
+#include <filesystem> // For std::filesystem::file_size, std::filesystem::remove_all
+#include <iomanip>    // For std::setprecision
+#include <iostream>   // For std::cout, std::cerr
+#include <limits>     // For std::numeric_limits
+#include <random>     // For std::mt19937_64
+#include <string>     // For std::string
+#include <vector>     // For std::vector
+
+#include "data/tick_archive.h"
+
+namespace {
+    using tick_archive::ChainBatch;
+    using tick_archive::ChainTick;
+    using tick_archive::TickArchiveReader;
+    using tick_archive::TickArchiveWriter;
+
+    constexpr std::uint32_t BLOCK_ROWS = 10;
+
+    int failures = 0;
+
+    void expect(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAIL: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    // Snapshots of 3 to 23 rows, so many of them are larger than BLOCK_ROWS.
+    // Timestamps step unevenly; odd snapshots carry arbitrary (non-decimal) doubles.
+    std::vector<ChainTick> make_ticks(int snapshots, bool decimal_only) {
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::vector<ChainTick> ticks;
+        std::int64_t timestamp = 1700000000000;
+        double spot = 4500.0;
+        for (int s = 0; s < snapshots; ++s) {
+            timestamp += 250 * static_cast<std::int64_t>(1 + rng() % 4);
+            spot = std::round((spot + 2.0 * (unit(rng) - 0.5)) * 100.0) / 100.0;
+            bool arbitrary = !decimal_only && s % 2 == 1;
+            int rows = 3 + static_cast<int>(rng() % 21);
+            for (int r = 0; r < rows; ++r) {
+                ChainTick tick;
+                tick.timestamp = timestamp;
+                tick.spot_price = arbitrary ? spot + unit(rng) : spot;
+                tick.option.strike_price = 4300.0 + 25.0 * r;
+                tick.option.time_to_expiration = 0.25 - 1e-6 * s;
+                tick.option.type = r % 2 == 0 ? OptionType::Call : OptionType::Put;
+                double price = std::max(0.05, 200.0 - 10.0 * r + 5.0 * unit(rng));
+                tick.option.market_price = arbitrary ? price : std::round(price * 100.0) / 100.0;
+                ticks.push_back(tick);
+            }
+        }
+        return ticks;
+    }
+
+    bool write_archive(const std::string& path, const std::vector<ChainTick>& ticks, std::uint32_t block_rows) {
+        TickArchiveWriter writer(block_rows);
+        if (!writer.open(path)) return false;
+        for (const ChainTick& tick : ticks) {
+            if (!writer.append(tick)) return false;
+        }
+        return writer.close();
+    }
+
+    bool same_tick(const ChainTick& a, const ChainTick& b) {
+        return a.timestamp == b.timestamp && a.spot_price == b.spot_price &&
+               a.option.strike_price == b.option.strike_price &&
+               a.option.time_to_expiration == b.option.time_to_expiration && a.option.type == b.option.type &&
+               a.option.market_price == b.option.market_price;
+    }
+
+    // Reads the selected range, checking that no snapshot is split across batches.
+    std::vector<ChainTick> read_range(TickArchiveReader& reader, std::int64_t first, std::int64_t last,
+                                      const std::string& label) {
+        reader.seek(first, last);
+        std::vector<ChainTick> rows;
+        ChainBatch batch;
+        std::int64_t previous_last = std::numeric_limits<std::int64_t>::min();
+        while (reader.next_batch(batch)) {
+            expect(!batch.empty(), label + ": no empty batches");
+            if (batch.empty()) continue;
+            expect(batch.timestamps.front() > previous_last, label + ": snapshot split across batches");
+            previous_last = batch.timestamps.back();
+            for (std::size_t i = 0; i < batch.size(); ++i) rows.push_back(batch.row(i));
+        }
+        return rows;
+    }
+
+    void expect_range(TickArchiveReader& reader, const std::vector<ChainTick>& ticks, std::int64_t first,
+                      std::int64_t last, const std::string& label) {
+        std::vector<ChainTick> expected;
+        for (const ChainTick& tick : ticks) {
+            if (tick.timestamp >= first && tick.timestamp <= last) expected.push_back(tick);
+        }
+        std::vector<ChainTick> rows = read_range(reader, first, last, label);
+        bool same = rows.size() == expected.size();
+        for (std::size_t i = 0; same && i < rows.size(); ++i) same = same_tick(rows[i], expected[i]);
+        expect(same, label + ": " + std::to_string(rows.size()) + " rows read, " + std::to_string(expected.size()) +
+                         " expected");
+    }
+
+    void check_round_trip_and_seek(const std::string& directory) {
+        const std::string path = directory + "/chain.vtar";
+        const std::vector<ChainTick> ticks = make_ticks(300, false);
+        expect(write_archive(path, ticks, BLOCK_ROWS), "write archive");
+
+        TickArchiveReader reader;
+        if (!reader.open(path)) {
+            expect(false, "open archive");
+            return;
+        }
+        expect(reader.row_count() == ticks.size(), "row count");
+        expect_range(reader, ticks, std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max(),
+                     "full replay");
+
+        // Every block holds whole snapshots, and each boundary is probed from both sides
+        const auto& index = reader.index();
+        std::size_t oversized = 0;
+        for (std::size_t b = 0; b < index.size(); ++b) {
+            oversized += index[b].row_count > BLOCK_ROWS ? 1 : 0;
+            if (b > 0) {
+                expect(index[b].first_timestamp > index[b - 1].last_timestamp,
+                       "timestamp shared by blocks " + std::to_string(b - 1) + " and " + std::to_string(b));
+            }
+            std::string block = "block " + std::to_string(b);
+            expect_range(reader, ticks, index[b].first_timestamp, index[b].last_timestamp, block);
+            expect_range(reader, ticks, index[b].first_timestamp, index[b].first_timestamp, block + " first snapshot");
+            expect_range(reader, ticks, index[b].last_timestamp, index[b].last_timestamp, block + " last snapshot");
+            expect_range(reader, ticks, index[b].first_timestamp, std::numeric_limits<std::int64_t>::max(),
+                         "from " + block);
+            if (b + 1 < index.size()) {
+                expect_range(reader, ticks, index[b].last_timestamp, index[b + 1].first_timestamp,
+                             "across the end of " + block);
+            }
+        }
+        expect(oversized > 0, "some blocks run past block_rows to keep snapshots whole");
+
+        // Empty ranges: inverted, in a gap between snapshots, before the start and after the end
+        std::int64_t gap = ticks.front().timestamp;
+        for (std::size_t i = 1; i < ticks.size(); ++i) {
+            if (ticks[i].timestamp - ticks[i - 1].timestamp > 1) {
+                gap = ticks[i - 1].timestamp + 1;
+                break;
+            }
+        }
+        expect(read_range(reader, ticks.back().timestamp, ticks.front().timestamp, "inverted").empty(),
+               "inverted range is empty");
+        expect(read_range(reader, gap, gap, "gap").empty(), "range between snapshots is empty");
+        expect(read_range(reader, 0, ticks.front().timestamp - 1, "before").empty(), "range before the start is empty");
+        expect(read_range(reader, ticks.back().timestamp + 1, std::numeric_limits<std::int64_t>::max(), "after").empty(),
+               "range after the end is empty");
+
+        std::cout << "Round trip: " << ticks.size() << " rows in " << index.size() << " blocks (" << oversized
+                  << " past block_rows); every block boundary seeked" << std::endl;
+    }
+
+    void check_empty_archive(const std::string& directory) {
+        const std::string path = directory + "/empty.vtar";
+        expect(write_archive(path, {}, BLOCK_ROWS), "write empty archive");
+        TickArchiveReader reader;
+        bool opened = reader.open(path);
+        expect(opened, "open empty archive");
+        if (opened) {
+            ChainBatch batch;
+            expect(reader.row_count() == 0 && reader.index().empty(), "empty archive has no blocks");
+            expect(!reader.next_batch(batch), "empty archive yields no batch");
+            reader.seek(0, std::numeric_limits<std::int64_t>::max());
+            expect(!reader.next_batch(batch), "seeked empty archive yields no batch");
+        }
+
+        TickArchiveWriter writer(BLOCK_ROWS);
+        expect(writer.open(directory + "/backwards.vtar"), "open writer");
+        ChainTick tick;
+        tick.timestamp = 1000;
+        expect(writer.append(tick), "append first tick");
+        tick.timestamp = 999;
+        expect(!writer.append(tick), "timestamp going backwards is rejected");
+        writer.close();
+    }
+
+    void report_size_and_speed(const std::string& directory) {
+        const std::vector<ChainTick> ticks = make_ticks(60000, true); // About 800k rows
+        const std::string path = directory + "/history.vtar";
+        expect(write_archive(path, ticks, tick_archive::DEFAULT_BLOCK_ROWS), "write history");
+
+        // CSV with the shortest text that reads back to the same doubles
+        std::uintmax_t csv_bytes = 0;
+        char buffer[64];
+        for (const ChainTick& tick : ticks) {
+            for (double value : {tick.spot_price, tick.option.strike_price, tick.option.time_to_expiration,
+                                 tick.option.market_price}) {
+                csv_bytes += static_cast<std::uintmax_t>(std::to_chars(buffer, buffer + sizeof(buffer), value).ptr - buffer) + 1;
+            }
+            csv_bytes += static_cast<std::uintmax_t>(std::to_chars(buffer, buffer + sizeof(buffer), tick.timestamp).ptr - buffer);
+            csv_bytes += 3; // ",C" and the newline
+        }
+        const std::uintmax_t archive_bytes = std::filesystem::file_size(path);
+
+        TickArchiveReader reader;
+        ChainBatch batch;
+        std::uint64_t rows = 0;
+        auto start = std::chrono::steady_clock::now();
+        if (reader.open(path)) {
+            while (reader.next_batch(batch)) rows += batch.size();
+        }
+        auto end = std::chrono::steady_clock::now();
+        expect(rows == ticks.size(), "history decodes fully");
+
+        std::cout << std::fixed << std::setprecision(1) << "History: " << ticks.size() << " rows, archive "
+                  << archive_bytes << " bytes, CSV " << csv_bytes << " bytes (" << static_cast<double>(csv_bytes) / archive_bytes
+                  << "x smaller), decode " << std::chrono::duration<double, std::nano>(end - start).count() / rows
+                  << " ns/row" << std::endl;
+    }
+}
+
+int main() {
+    char directory_template[] = "/tmp/tick_archive_test_XXXXXX";
+    if (mkdtemp(directory_template) == nullptr) {
+        std::cerr << "Error: Could not create a temporary directory." << std::endl;
+        return 2;
+    }
+    const std::string directory = directory_template;
+
+    check_round_trip_and_seek(directory);
+    check_empty_archive(directory);
+    report_size_and_speed(directory);
+
+    std::filesystem::remove_all(directory);
+    std::cout << (failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+// Checks Heston prices against an independent reference and times calibration.
+//
+// The reference uses the Albrecher et al. (2007) form of the characteristic
+// function, the two-probability (P1, P2) formula and a fine midpoint rule,
+// so it shares no code or formulation with the pricer's control-variate
+// Gauss-Legendre scheme. The grid covers short expiries and deep out-of-the-
+// money strikes, where a coarse quadrature breaks down. Chains priced off rate
+// and dividend curves are checked against flat per-expiry pricing.
+//
+// Usage: heston_test
+
+#include <algorithm> // For std::max
+#include <chrono>    // For std::chrono::steady_clock
+#include <cmath>     // For std::exp, std::log, std::abs
+#include <complex>   // For std::complex
+#include <iomanip>   // For std::setprecision
+#include <iostream>  // For std::cout, std::cerr
+#include <numbers>   // For std::numbers::pi
+#include <vector>    // For std::vector
+
+#include "models/heston.h"
+
+namespace {
+    using Complex = std::complex<double>;
+
+    constexpr double PRICE_TOLERANCE = 1e-5; // Absolute, for a spot of 100
+    constexpr long REFERENCE_POINTS = 200000;
+
+    int failures = 0;
+
+    // E[exp(iu ln(S_T / F))] in the "little Heston trap" form.
+    Complex reference_characteristic_function(Complex u, double tau, const HestonParameters& p) {
+        const Complex i(0.0, 1.0);
+        const double sigma2 = p.vol_of_vol * p.vol_of_vol;
+        Complex b = p.mean_reversion - p.correlation * p.vol_of_vol * i * u;
+        Complex d = std::sqrt(b * b + sigma2 * (i * u + u * u));
+        Complex g = (b - d) / (b + d);
+        Complex e = std::exp(-d * tau);
+        Complex c = p.mean_reversion * p.long_run_variance / sigma2 *
+                    ((b - d) * tau - 2.0 * std::log((1.0 - g * e) / (1.0 - g)));
+        Complex dv = (b - d) / sigma2 * (1.0 - e) / (1.0 - g * e);
+        return std::exp(c + dv * p.initial_variance);
+    }
+
+    // Reference prices for several strikes of one expiry:
+    // call = D (F P1 - K P2), P_j = 1/2 + 1/pi int_0^inf Re[e^{-iuk} f_j(u) / (iu)] du.
+    // The integrands are even in u, so the midpoint rule converges spectrally.
+    std::vector<double> reference_prices(const std::vector<OptionData>& options, double tau,
+                                         const MarketData& market, const HestonParameters& p) {
+        const Complex i(0.0, 1.0);
+        const double discount = std::exp(-market.risk_free_rate * tau);
+        const double forward = market.spot_price * std::exp((market.risk_free_rate - market.dividend_yield) * tau);
+
+        double limit = 10.0;
+        while (limit < 1e5 && std::abs(reference_characteristic_function(Complex(limit), tau, p)) * forward / limit > 1e-15) {
+            limit *= 1.2;
+        }
+        const double step = limit / REFERENCE_POINTS;
+        std::vector<Complex> f1(REFERENCE_POINTS), f2(REFERENCE_POINTS);
+        for (long j = 0; j < REFERENCE_POINTS; ++j) {
+            double u = (static_cast<double>(j) + 0.5) * step;
+            f1[j] = reference_characteristic_function(Complex(u, -1.0), tau, p) / (i * u);
+            f2[j] = reference_characteristic_function(Complex(u), tau, p) / (i * u);
+        }
+
+        std::vector<double> prices;
+        for (const OptionData& option : options) {
+            double k = std::log(option.strike_price / forward);
+            double s1 = 0.0;
+            double s2 = 0.0;
+            for (long j = 0; j < REFERENCE_POINTS; ++j) {
+                double u = (static_cast<double>(j) + 0.5) * step;
+                Complex rotation(std::cos(u * k), -std::sin(u * k));
+                s1 += std::real(rotation * f1[j]);
+                s2 += std::real(rotation * f2[j]);
+            }
+            double p1 = 0.5 + s1 * step / std::numbers::pi;
+            double p2 = 0.5 + s2 * step / std::numbers::pi;
+            double call = discount * (forward * p1 - option.strike_price * p2);
+            prices.push_back(option.type == OptionType::Call ? call
+                                                             : call - discount * (forward - option.strike_price));
+        }
+        return prices;
+    }
+
+    void check_against_reference() {
+        const MarketData market(100.0, 0.03, 0.01);
+        const HestonParameters parameter_sets[] = {
+            {0.05, 0.06, -0.65, 2.0, 0.6},   // Typical equity skew
+            {0.0025, 0.04, 0.0, 0.5, 0.2},   // Very low current variance
+            {0.01, 0.02, -0.3, 1.0, 0.1},    // Low vol of vol
+            {0.2, 0.1, -0.9, 5.0, 1.5},      // High vol of vol, strong skew
+            {0.09, 0.09, 0.5, 10.0, 2.0},    // Positive correlation, fast reversion
+        };
+        const double expiries[] = {0.005, 0.02, 0.1, 0.5, 2.0};
+        const double strikes[] = {50.0, 60.0, 80.0, 95.0, 100.0, 105.0, 120.0, 150.0, 200.0};
+
+        double worst = 0.0;
+        int contracts = 0;
+        for (const HestonParameters& params : parameter_sets) {
+            std::vector<OptionData> chain;
+            std::vector<double> reference;
+            for (double tau : expiries) {
+                std::vector<OptionData> expiry_chain;
+                for (double strike : strikes) {
+                    for (OptionType type : {OptionType::Call, OptionType::Put}) {
+                        expiry_chain.push_back(OptionData{strike, tau, type, 0.0});
+                    }
+                }
+                std::vector<double> prices = reference_prices(expiry_chain, tau, market, params);
+                chain.insert(chain.end(), expiry_chain.begin(), expiry_chain.end());
+                reference.insert(reference.end(), prices.begin(), prices.end());
+            }
+
+            std::vector<double> chain_prices = heston_prices(chain, market, params);
+            for (std::size_t c = 0; c < chain.size(); ++c) {
+                const OptionData& option = chain[c];
+                double single = heston_price(option, market, params);
+                double error = std::max(std::abs(chain_prices[c] - reference[c]), std::abs(single - reference[c]));
+                worst = std::max(worst, error);
+                ++contracts;
+                if (error > PRICE_TOLERANCE || chain_prices[c] < 0.0 || single < 0.0) {
+                    std::cerr << "FAIL: v0 " << params.initial_variance << " sigma " << params.vol_of_vol
+                              << " T " << option.time_to_expiration << " K " << option.strike_price << ' '
+                              << to_string(option.type) << ": chain " << chain_prices[c] << ", single " << single
+                              << ", reference " << reference[c] << std::endl;
+                    ++failures;
+                }
+            }
+        }
+        std::cout << std::scientific << std::setprecision(2) << "Reference check: " << contracts
+                  << " contracts, worst absolute error " << worst << " (tolerance " << PRICE_TOLERANCE << ")"
+                  << std::defaultfloat << std::endl;
+    }
+
+    // Prices are never below the discounted intrinsic forward value.
+    void check_no_arbitrage_floor() {
+        const MarketData market(100.0, 0.03, 0.01);
+        const HestonParameters params{0.0025, 0.04, 0.0, 0.5, 0.2};
+        for (double strike : {30.0, 50.0, 200.0, 400.0}) {
+            for (OptionType type : {OptionType::Call, OptionType::Put}) {
+                double tau = 0.005;
+                double forward = market.spot_price * std::exp((market.risk_free_rate - market.dividend_yield) * tau);
+                double intrinsic = type == OptionType::Call ? forward - strike : strike - forward;
+                double floor = std::exp(-market.risk_free_rate * tau) * std::max(intrinsic, 0.0);
+                double price = heston_price(OptionData{strike, tau, type, 0.0}, market, params);
+                if (price < floor) {
+                    std::cerr << "FAIL: price " << price << " below floor " << floor << " at K " << strike << std::endl;
+                    ++failures;
+                }
+            }
+        }
+    }
+
+    // A chain priced off rate and dividend curves matches each expiry priced alone
+    // at the flat rate and yield the curves give for that expiry. Chains are
+    // compared with chains and single prices with single prices, so both sides
+    // use the same quadrature grid.
+    void check_curves() {
+        const double spot = 100.0;
+        const TermStructure rates({0.25, 1.0, 2.0}, {0.01, 0.03, 0.035});
+        const TermStructure dividends({0.5, 2.0}, {0.02, 0.005});
+        const HestonParameters params{0.05, 0.06, -0.65, 2.0, 0.6};
+        std::vector<OptionData> chain;
+        std::vector<double> expected;
+        for (double tau : {0.1, 0.25, 0.6, 1.5, 3.0}) {
+            std::vector<OptionData> expiry_chain;
+            for (double strike : {80.0, 100.0, 125.0}) {
+                for (OptionType type : {OptionType::Call, OptionType::Put}) {
+                    expiry_chain.push_back(OptionData{strike, tau, type, 0.0});
+                }
+            }
+            std::vector<double> prices =
+                heston_prices(expiry_chain, MarketData(spot, rates.rate(tau), dividends.rate(tau)), params);
+            chain.insert(chain.end(), expiry_chain.begin(), expiry_chain.end());
+            expected.insert(expected.end(), prices.begin(), prices.end());
+        }
+        std::vector<double> prices = heston_prices(chain, spot, rates, dividends, params);
+        double worst = 0.0;
+        for (std::size_t c = 0; c < chain.size(); ++c) {
+            double tau = chain[c].time_to_expiration;
+            double single = heston_price(chain[c], make_expiry_factors(spot, rates, dividends, tau), params);
+            double flat = heston_price(chain[c], MarketData(spot, rates.rate(tau), dividends.rate(tau)), params);
+            worst = std::max({worst, std::abs(prices[c] - expected[c]), std::abs(single - flat)});
+        }
+        std::cout << std::scientific << std::setprecision(2) << "Curve check: " << chain.size()
+                  << " contracts, worst difference from flat per-expiry pricing " << worst << std::defaultfloat
+                  << std::endl;
+        if (worst > 1e-12) {
+            std::cerr << "FAIL: curve pricing differs from flat per-expiry pricing by " << worst << std::endl;
+            ++failures;
+        }
+    }
+
+    // 500-contract chain: 10 expiries x 25 strikes x call/put, priced with known parameters.
+    void time_calibration() {
+        const MarketData market(100.0, 0.03, 0.01);
+        const HestonParameters truth{0.05, 0.06, -0.65, 2.0, 0.6};
+        std::vector<OptionData> chain;
+        for (double tau : {0.05, 0.1, 0.25, 0.5, 0.75, 1.0, 1.25, 1.5, 1.75, 2.0}) {
+            for (int s = 0; s < 25; ++s) {
+                for (OptionType type : {OptionType::Call, OptionType::Put}) {
+                    chain.push_back(OptionData{70.0 + 2.5 * s, tau, type, 0.0});
+                }
+            }
+        }
+        std::vector<double> prices = heston_prices(chain, market, truth);
+        for (std::size_t c = 0; c < chain.size(); ++c) chain[c].market_price = prices[c];
+
+        auto start = std::chrono::steady_clock::now();
+        HestonCalibrationResult result = calibrate_heston(chain, market, HestonParameters{});
+        auto end = std::chrono::steady_clock::now();
+
+        const HestonParameters& fit = result.parameters;
+        bool recovered = std::abs(fit.initial_variance - truth.initial_variance) < 1e-4 &&
+                         std::abs(fit.long_run_variance - truth.long_run_variance) < 1e-4 &&
+                         std::abs(fit.correlation - truth.correlation) < 1e-3 &&
+                         std::abs(fit.mean_reversion - truth.mean_reversion) < 1e-2 &&
+                         std::abs(fit.vol_of_vol - truth.vol_of_vol) < 1e-3;
+        std::cout << std::setprecision(3) << "Calibration: " << chain.size() << " contracts, "
+                  << result.iterations << " iterations, rmse " << result.rmse << ", "
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+        if (!result.converged || !recovered) {
+            std::cerr << "FAIL: calibration did not recover the parameters (v0 " << fit.initial_variance
+                      << ", theta " << fit.long_run_variance << ", rho " << fit.correlation << ", kappa "
+                      << fit.mean_reversion << ", sigma " << fit.vol_of_vol << ")" << std::endl;
+            ++failures;
+        }
+    }
+}
+
+int main() {
+    check_against_reference();
+    check_no_arbitrage_floor();
+    check_curves();
+    time_calibration();
+
+    std::cout << (failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+// Concurrent stress test for RiskEngine.
+//
+// Many threads reserve, partly release and close positions on a shared book
+// while a monitor thread checks that no limit is ever exceeded. Prints reserve()
+// latency percentiles; exits non-zero on a breach or an inconsistent book.
+// A second, small book is then filled past its max_contracts from several
+// threads to check that the contract capacity holds and that rejected trades do
+// not use it up.
+//
+// Usage: risk_engine_stress_test [threads] [operations_per_thread]
+
+#include <algorithm> // For std::sort, std::max
+#include <atomic>    // For std::atomic
+#include <chrono>    // For std::chrono::steady_clock
+#include <cmath>     // For std::abs
+#include <cstdint>   // For std::uint64_t
+#include <cstdlib>   // For std::atoi
+#include <iomanip>   // For std::setprecision
+#include <iostream>  // For std::cout, std::cerr
+#include <random>    // For std::mt19937_64
+#include <thread>    // For std::thread
+#include <vector>    // For std::vector
+
+#include "models/risk_engine.h"
+
+namespace {
+    constexpr double TOTAL_CAPITAL = 2.0e5;
+    constexpr double MAX_LOSS = 5.0e4;
+    constexpr double MAX_ABS_DELTA = 100.0;
+    constexpr double MAX_ABS_VEGA = 400.0;
+    constexpr std::size_t UNDERLYINGS = 8;
+    constexpr std::uint64_t CONTRACTS_PER_THREAD = 32;
+    constexpr double TOLERANCE = 1e-6;
+
+    struct ThreadResult {
+        std::vector<double> latencies_ns;
+        long accepted = 0;
+        long position_mismatches = 0;
+    };
+
+    // Each thread owns its contracts, so it can track their expected quantities without locking.
+    void trade(RiskEngine& engine, int thread, int operations, ThreadResult& result) {
+        std::mt19937_64 rng(static_cast<std::uint64_t>(thread) + 1);
+        std::uniform_real_distribution<double> unit(-1.0, 1.0);
+        const std::uint64_t first_contract = static_cast<std::uint64_t>(thread) * CONTRACTS_PER_THREAD;
+
+        std::vector<TradeRequest> open_trades;
+        std::vector<double> expected_quantity(CONTRACTS_PER_THREAD, 0.0);
+        result.latencies_ns.reserve(static_cast<std::size_t>(operations));
+
+        for (int i = 0; i < operations; ++i) {
+            std::uint64_t action = rng() % 8;
+            if (!open_trades.empty() && (open_trades.size() > 20 || action < 2)) {
+                // Cancel the most recent order
+                const TradeRequest& trade = open_trades.back();
+                engine.release(trade);
+                expected_quantity[trade.contract_id - first_contract] -= trade.quantity;
+                open_trades.pop_back();
+                continue;
+            }
+            if (action == 2) {
+                // Close a whole position without replaying its trades
+                std::uint64_t local = rng() % CONTRACTS_PER_THREAD;
+                ContractPosition closed = engine.close_position(first_contract + local);
+                if (std::abs(closed.quantity - expected_quantity[local]) > TOLERANCE) {
+                    ++result.position_mismatches;
+                }
+                expected_quantity[local] = 0.0;
+                std::erase_if(open_trades, [&](const TradeRequest& trade) {
+                    return trade.contract_id == first_contract + local;
+                });
+                continue;
+            }
+
+            std::uint64_t local = rng() % CONTRACTS_PER_THREAD;
+            TradeRequest trade{};
+            trade.contract_id = first_contract + local;
+            trade.underlying = static_cast<std::size_t>(trade.contract_id % UNDERLYINGS);
+            trade.quantity = unit(rng) > 0.0 ? 1.0 : -1.0;
+            trade.capital = 500.0 + 400.0 * unit(rng);
+            // Cancelling a trade that reduced an exposure raises it again, and release()
+            // never refuses; so every trade on an underlying adds exposure in the same
+            // direction, and any breach the monitor sees must have come from reserve().
+            double side = trade.underlying % 2 == 0 ? 1.0 : -1.0;
+            trade.delta = side * 40.0 * (unit(rng) + 1.0) / 2.0;
+            trade.vega = side * 150.0 * (unit(rng) + 1.0) / 2.0;
+            trade.max_loss = 300.0 + 200.0 * unit(rng);
+
+            auto start = std::chrono::steady_clock::now();
+            RiskCheckResult check = engine.reserve(trade);
+            auto end = std::chrono::steady_clock::now();
+            result.latencies_ns.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+
+            if (check == RiskCheckResult::Accepted) {
+                open_trades.push_back(trade);
+                expected_quantity[local] += trade.quantity;
+                ++result.accepted;
+            }
+        }
+
+        for (std::uint64_t local = 0; local < CONTRACTS_PER_THREAD; ++local) {
+            if (std::abs(engine.position(first_contract + local).quantity - expected_quantity[local]) > TOLERANCE) {
+                ++result.position_mismatches;
+            }
+            engine.close_position(first_contract + local);
+        }
+    }
+
+    // Fills a 64-contract book with trades on 4x as many distinct contracts.
+    bool check_contract_capacity() {
+        constexpr std::size_t MAX_CONTRACTS = 64;
+        constexpr int FILLERS = 4;
+        RiskEngine engine(TOTAL_CAPITAL, MAX_LOSS, 1, MAX_CONTRACTS);
+        engine.add_underlying({MAX_ABS_DELTA, MAX_ABS_VEGA});
+        bool passed = true;
+        auto expect = [&](bool condition, const char* what) {
+            if (!condition) {
+                std::cerr << "FAIL: " << what << std::endl;
+                passed = false;
+            }
+        };
+
+        // Trades rejected on a limit must not take contract slots
+        long rejected = 0;
+        for (std::uint64_t id = 0; id < 10 * MAX_CONTRACTS; ++id) {
+            TradeRequest trade{0, 1000000 + id, 1.0, 1.0, 2.0 * MAX_ABS_DELTA, 0.0, 1.0};
+            rejected += engine.reserve(trade) == RiskCheckResult::DeltaLimit;
+        }
+        expect(rejected == static_cast<long>(10 * MAX_CONTRACTS) && engine.contract_count() == 0,
+               "limit rejections took no contract slots");
+
+        std::atomic<long> accepted{0};
+        std::atomic<long> full{0};
+        std::vector<std::thread> fillers;
+        for (int t = 0; t < FILLERS; ++t) {
+            fillers.emplace_back([&, t] {
+                for (std::uint64_t i = 0; i < MAX_CONTRACTS; ++i) {
+                    TradeRequest trade{0, static_cast<std::uint64_t>(t) * MAX_CONTRACTS + i, 1.0, 1.0, 0.0, 0.0, 1.0};
+                    RiskCheckResult result = engine.reserve(trade);
+                    if (result == RiskCheckResult::Accepted) accepted.fetch_add(1, std::memory_order_relaxed);
+                    if (result == RiskCheckResult::PositionBookFull) full.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        for (std::thread& filler : fillers) filler.join();
+
+        expect(accepted.load() == static_cast<long>(MAX_CONTRACTS), "exactly max_contracts contracts accepted");
+        expect(full.load() == static_cast<long>((FILLERS - 1) * MAX_CONTRACTS), "every other contract rejected as book full");
+        expect(engine.contract_count() == MAX_CONTRACTS, "contract count stops at max_contracts");
+
+        TradeRequest extra{0, 999999, 1.0, 1.0, 0.0, 0.0, 1.0};
+        expect(engine.check(extra) == RiskCheckResult::PositionBookFull &&
+                   engine.reserve(extra) == RiskCheckResult::PositionBookFull,
+               "new contract rejected once full");
+
+        long booked = 0;
+        for (std::uint64_t id = 0; id < FILLERS * MAX_CONTRACTS; ++id) {
+            if (engine.position(id).quantity == 0.0) continue;
+            ++booked;
+            TradeRequest more{0, id, 1.0, 1.0, 0.0, 0.0, 1.0};
+            expect(engine.reserve(more) == RiskCheckResult::Accepted, "booked contract still trades when full");
+        }
+        expect(booked == static_cast<long>(MAX_CONTRACTS), "booked positions match accepted trades");
+        expect(engine.position(999999).quantity == 0.0, "unknown contract has no position");
+
+        std::cout << "Contract capacity: " << MAX_CONTRACTS << ", accepted " << accepted.load() << ", book full "
+                  << full.load() << ", limit rejections " << rejected << std::endl;
+        return passed;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? std::atoi(argv[1])
+                           : static_cast<int>(std::max(32u, std::thread::hardware_concurrency()));
+    int operations = argc > 2 ? std::atoi(argv[2]) : 20000;
+    if (threads <= 0 || operations <= 0) {
+        std::cerr << "Usage: risk_engine_stress_test [threads] [operations_per_thread]" << std::endl;
+        return 2;
+    }
+
+    RiskEngine engine(TOTAL_CAPITAL, MAX_LOSS, UNDERLYINGS,
+                      static_cast<std::size_t>(threads) * CONTRACTS_PER_THREAD);
+    for (std::size_t i = 0; i < UNDERLYINGS; ++i) engine.add_underlying({MAX_ABS_DELTA, MAX_ABS_VEGA});
+
+    std::atomic<bool> running{true};
+    std::atomic<long> breaches{0};
+    std::thread monitor([&] {
+        while (running.load(std::memory_order_relaxed)) {
+            for (std::size_t i = 0; i < UNDERLYINGS; ++i) {
+                UnderlyingExposure exposure = engine.exposure(i);
+                if (std::abs(exposure.delta) > MAX_ABS_DELTA + TOLERANCE ||
+                    std::abs(exposure.vega) > MAX_ABS_VEGA + TOLERANCE) {
+                    breaches.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            if (engine.used_capital() > TOTAL_CAPITAL + TOLERANCE ||
+                engine.reserved_loss() > MAX_LOSS + TOLERANCE) {
+                breaches.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    std::vector<ThreadResult> results(static_cast<std::size_t>(threads));
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back(trade, std::ref(engine), t, operations, std::ref(results[static_cast<std::size_t>(t)]));
+    }
+    for (std::thread& worker : workers) worker.join();
+    auto end = std::chrono::steady_clock::now();
+    running.store(false, std::memory_order_relaxed);
+    monitor.join();
+
+    std::vector<double> latencies;
+    long accepted = 0;
+    long mismatches = 0;
+    for (const ThreadResult& result : results) {
+        latencies.insert(latencies.end(), result.latencies_ns.begin(), result.latencies_ns.end());
+        accepted += result.accepted;
+        mismatches += result.position_mismatches;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        return latencies.empty() ? 0.0 : latencies[static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1))];
+    };
+
+    double residual = std::abs(engine.used_capital()) + std::abs(engine.reserved_loss());
+    for (std::size_t i = 0; i < UNDERLYINGS; ++i) {
+        UnderlyingExposure exposure = engine.exposure(i);
+        residual += std::abs(exposure.delta) + std::abs(exposure.vega) + std::abs(exposure.capital);
+    }
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "Threads: " << threads << " (hardware concurrency " << std::thread::hardware_concurrency() << ")"
+              << ", reserves: " << latencies.size() << ", accepted: " << accepted
+              << ", wall: " << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+    std::cout << "reserve() latency p50: " << percentile(0.50) << " ns, p99: " << percentile(0.99)
+              << " ns, p99.9: " << percentile(0.999) << " ns, max: " << (latencies.empty() ? 0.0 : latencies.back())
+              << " ns" << std::endl;
+    std::cout << std::setprecision(3) << "Limit breaches: " << breaches.load() << ", position mismatches: " << mismatches
+              << ", residual exposure after closing: " << residual << std::endl;
+
+    bool passed = breaches.load() == 0 && mismatches == 0 && residual < 1e-3;
+    passed = check_contract_capacity() && passed;
+    std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
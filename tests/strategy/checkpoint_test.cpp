@@ -0,0 +1,210 @@
+// Round-trips strategy checkpoints through files and checks that damaged ones
+// are rejected: a flipped byte anywhere fails the checksum or the header, every
+// truncation fails, and a payload whose rolling-volatility count does not match
+// its returns is refused even with a valid checksum. Also replays a price file
+// in batches, checkpointing after each one, and checks that resuming from any
+// of those checkpoints gives the state of an uninterrupted replay.
+//
+// Usage: checkpoint_test
+
+#include <cstdlib>    // For mkdtemp
+#include <filesystem> // For std::filesystem::remove_all, std::filesystem::resize_file
+#include <fstream>    // For std::ifstream, std::ofstream
+#include <iostream>   // For std::cout, std::cerr
+#include <iterator>   // For std::istreambuf_iterator
+#include <optional>   // For std::optional
+#include <string>     // For std::string
+#include <vector>     // For std::vector
+
+#include "data/data_loader.h"
+#include "strategy/checkpoint.h"
+
+namespace {
+    int failures = 0;
+
+    void expect(bool condition, const std::string& what) {
+        if (!condition) {
+            std::cerr << "FAIL: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    std::vector<char> read_bytes(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<char>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+
+    void write_bytes(const std::string& path, const std::vector<char>& bytes) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    checkpoint::Checkpoint sample_checkpoint() {
+        RollingVolatility rv(20);
+        double price = 100.0;
+        for (int i = 0; i < 57; ++i) {
+            price *= 1.0 + 0.01 * ((i * 37) % 11 - 5) / 5.0;
+            rv.add_price(price);
+        }
+
+        checkpoint::Checkpoint saved;
+        saved.strategy.events_applied = 57;
+        saved.strategy.realized_vol = rv.state();
+        saved.strategy.surface = HestonParameters{0.05, 0.06, -0.65, 2.0, 0.6};
+        for (std::uint64_t id : {3ull, 17ull, 1ull << 63}) {
+            saved.strategy.contracts.push_back(ContractState{id, 0.2 + 1e-3 * static_cast<double>(id % 7), -2.0, 4.25});
+        }
+        saved.source_offset = 1234;
+        saved.source_fingerprint = 0x0123456789abcdefull;
+        return saved;
+    }
+
+    bool same_checkpoint(const checkpoint::Checkpoint& a, const checkpoint::Checkpoint& b) {
+        const RollingVolatility::State& x = a.strategy.realized_vol;
+        const RollingVolatility::State& y = b.strategy.realized_vol;
+        bool same = a.source_offset == b.source_offset && a.source_fingerprint == b.source_fingerprint &&
+                    a.strategy.events_applied == b.strategy.events_applied &&
+                    x.window == y.window && x.period == y.period && x.last_price == y.last_price &&
+                    x.count == y.count && x.mean == y.mean && x.sum_sq_diff == y.sum_sq_diff &&
+                    x.returns == y.returns && a.strategy.surface.has_value() == b.strategy.surface.has_value() &&
+                    a.strategy.contracts.size() == b.strategy.contracts.size();
+        if (same && a.strategy.surface.has_value()) {
+            const HestonParameters& p = *a.strategy.surface;
+            const HestonParameters& q = *b.strategy.surface;
+            same = p.initial_variance == q.initial_variance && p.long_run_variance == q.long_run_variance &&
+                   p.correlation == q.correlation && p.mean_reversion == q.mean_reversion && p.vol_of_vol == q.vol_of_vol;
+        }
+        for (std::size_t i = 0; same && i < a.strategy.contracts.size(); ++i) {
+            const ContractState& c = a.strategy.contracts[i];
+            const ContractState& d = b.strategy.contracts[i];
+            same = c.contract_id == d.contract_id && c.last_implied_vol == d.last_implied_vol &&
+                   c.position == d.position && c.average_price == d.average_price;
+        }
+        return same;
+    }
+
+    void check_round_trip_and_corruption(const std::string& directory) {
+        const std::string path = directory + "/strategy.vtck";
+        const checkpoint::Checkpoint saved = sample_checkpoint();
+        expect(checkpoint::write_checkpoint(path, saved), "write checkpoint");
+
+        std::optional<checkpoint::Checkpoint> loaded = checkpoint::read_checkpoint(path);
+        expect(loaded.has_value() && same_checkpoint(saved, *loaded), "checkpoint round-trips exactly");
+        if (loaded.has_value()) {
+            RollingVolatility original(20);
+            RollingVolatility restored(20);
+            original.restore(saved.strategy.realized_vol);
+            restored.restore(loaded->strategy.realized_vol);
+            expect(original.volatility() == restored.volatility(), "restored estimator gives the same volatility");
+        }
+
+        const std::vector<char> good = read_bytes(path);
+        const std::string damaged = directory + "/damaged.vtck";
+        std::size_t accepted_flips = 0;
+        for (std::size_t i = 0; i < good.size(); ++i) {
+            std::vector<char> bytes = good;
+            bytes[i] = static_cast<char>(bytes[i] ^ 0x10);
+            write_bytes(damaged, bytes);
+            if (checkpoint::read_checkpoint(damaged).has_value()) ++accepted_flips;
+        }
+        expect(accepted_flips == 0, std::to_string(accepted_flips) + " single-byte flips were accepted");
+
+        std::size_t accepted_truncations = 0;
+        for (std::size_t size = 0; size < good.size(); ++size) {
+            write_bytes(damaged, std::vector<char>(good.begin(), good.begin() + static_cast<std::ptrdiff_t>(size)));
+            if (checkpoint::read_checkpoint(damaged).has_value()) ++accepted_truncations;
+        }
+        expect(accepted_truncations == 0, std::to_string(accepted_truncations) + " truncations were accepted");
+
+        // Well-formed file whose estimator count disagrees with the returns it carries
+        checkpoint::Checkpoint inconsistent = saved;
+        inconsistent.strategy.realized_vol.count += 1;
+        expect(checkpoint::write_checkpoint(damaged, inconsistent) && !checkpoint::read_checkpoint(damaged).has_value(),
+               "count larger than the stored returns is rejected");
+        inconsistent = saved;
+        inconsistent.strategy.realized_vol.returns.pop_back();
+        expect(checkpoint::write_checkpoint(damaged, inconsistent) && !checkpoint::read_checkpoint(damaged).has_value(),
+               "returns fewer than the count are rejected");
+        inconsistent = saved;
+        inconsistent.strategy.realized_vol.window = 0; // Expanding estimator must not carry returns
+        expect(checkpoint::write_checkpoint(damaged, inconsistent) && !checkpoint::read_checkpoint(damaged).has_value(),
+               "expanding estimator with stored returns is rejected");
+
+        expect(!checkpoint::read_checkpoint(directory + "/missing.vtck").has_value(), "missing checkpoint");
+
+        std::cout << "Checkpoint of " << good.size() << " bytes: round trip, " << good.size()
+                  << " byte flips and truncations checked" << std::endl;
+    }
+
+    // Replays a price file in batches with a checkpoint after each one, as main.cpp does.
+    void check_batched_replay(const std::string& directory) {
+        const std::string prices_path = directory + "/prices.csv";
+        {
+            std::ofstream out(prices_path);
+            out << "price\n";
+            for (int i = 0; i < 250; ++i) out << 100.0 + 0.5 * ((i * 13) % 17) - 0.25 * (i % 5) << '\n';
+        }
+
+        ImpliedVolStrategy uninterrupted(20);
+        for (double price : data_loader::load_historical_prices_from_csv(prices_path)) uninterrupted.on_price(price);
+
+        ImpliedVolStrategy strategy(20);
+        std::uint64_t offset = 0;
+        std::vector<checkpoint::Checkpoint> checkpoints;
+        while (true) {
+            std::vector<double> batch = data_loader::load_historical_prices_from_csv(prices_path, offset, 32);
+            if (batch.empty()) break;
+            for (double price : batch) strategy.on_price(price);
+            checkpoints.push_back(checkpoint::Checkpoint{
+                strategy.state(), offset, data_loader::fingerprint_file_prefix(prices_path, offset).value_or(0)});
+        }
+        expect(checkpoints.size() == 8, "250 prices replayed in 8 batches of at most 32");
+
+        const std::string path = directory + "/replay.vtck";
+        for (const checkpoint::Checkpoint& taken : checkpoints) {
+            std::optional<checkpoint::Checkpoint> saved;
+            if (checkpoint::write_checkpoint(path, taken)) saved = checkpoint::read_checkpoint(path);
+            expect(saved.has_value() &&
+                       data_loader::fingerprint_file_prefix(prices_path, saved->source_offset) == saved->source_fingerprint,
+                   "checkpoint fingerprint matches the price file");
+            if (!saved.has_value()) continue;
+
+            ImpliedVolStrategy resumed(20);
+            resumed.restore(saved->strategy);
+            std::uint64_t resume_offset = saved->source_offset;
+            for (double price : data_loader::load_historical_prices_from_csv(prices_path, resume_offset)) {
+                resumed.on_price(price);
+            }
+            expect(resumed.events_applied() == uninterrupted.events_applied() &&
+                       resumed.state().realized_vol.returns == uninterrupted.state().realized_vol.returns,
+                   "resuming after " + std::to_string(saved->strategy.events_applied) + " prices matches the full replay");
+        }
+
+        // The background writer keeps the latest submission
+        {
+            checkpoint::CheckpointWriter writer(path);
+            for (const checkpoint::Checkpoint& taken : checkpoints) writer.submit(taken);
+            writer.flush();
+            expect(writer.failed_count() == 0 && writer.written_count() >= 1, "background writer wrote checkpoints");
+        }
+        std::optional<checkpoint::Checkpoint> latest = checkpoint::read_checkpoint(path);
+        expect(latest.has_value() && same_checkpoint(*latest, checkpoints.back()), "background writer kept the latest");
+        std::cout << "Batched replay: " << checkpoints.size() << " checkpoints resumed" << std::endl;
+    }
+}
+
+int main() {
+    char directory_template[] = "/tmp/checkpoint_test_XXXXXX";
+    if (mkdtemp(directory_template) == nullptr) {
+        std::cerr << "Error: Could not create a temporary directory." << std::endl;
+        return 2;
+    }
+    const std::string directory = directory_template;
+
+    check_round_trip_and_corruption(directory);
+    check_batched_replay(directory);
+
+    std::filesystem::remove_all(directory);
+    std::cout << (failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
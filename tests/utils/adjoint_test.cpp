@@ -0,0 +1,251 @@
+// Checks adjoint sensitivities against central finite differences and the
+// closed-form expiry-factor Greeks, checks that black_scholes_sensitivities
+// leaves a caller's tape active and that misusing tapes throws, and times
+// bump-and-reprice against one adjoint pass for books of 1, 10 and 100 inputs.
+//
+// Usage: adjoint_test [benchmark_repeats]
+
+#include <algorithm> // For std::max
+#include <chrono>    // For std::chrono::steady_clock
+#include <cmath>     // For std::abs
+#include <cstdlib>   // For std::atoi
+#include <iomanip>   // For std::setprecision
+#include <iostream>  // For std::cout, std::cerr
+#include <stdexcept> // For std::logic_error
+#include <vector>    // For std::vector
+
+#include "data/expiry_factors.h"
+#include "models/black_scholes.h"
+#include "utils/adjoint.h"
+
+namespace {
+    int failures = 0;
+
+    void expect_close(const char* what, double actual, double expected, double tolerance) {
+        if (std::abs(actual - expected) > tolerance * std::max(1.0, std::abs(expected))) {
+            std::cerr << "FAIL: " << what << ": " << actual << " vs " << expected << std::endl;
+            ++failures;
+        }
+    }
+
+    // Central difference of the double pricer with respect to input `index`.
+    double central_difference(double (&inputs)[6], int index, OptionType type) {
+        double original = inputs[index];
+        double step = 1e-5 * std::max(1.0, std::abs(original));
+        auto price = [&] {
+            return black_scholes_price<double>(inputs[0], inputs[1], inputs[2], inputs[3], inputs[4], inputs[5], type);
+        };
+        inputs[index] = original + step;
+        double up = price();
+        inputs[index] = original - step;
+        double down = price();
+        inputs[index] = original;
+        return (up - down) / (2.0 * step);
+    }
+
+    void check_finite_differences() {
+        const double spots[] = {80.0, 100.0, 125.0};
+        const double times[] = {0.05, 0.5, 2.0};
+        const double vols[] = {0.1, 0.25, 0.6};
+        int cases = 0;
+        for (OptionType type : {OptionType::Call, OptionType::Put}) {
+            for (double spot : spots) {
+                for (double time : times) {
+                    for (double vol : vols) {
+                        double inputs[6] = {spot, 100.0, time, 0.03, 0.01, vol};
+                        BlackScholesSensitivities s = black_scholes_sensitivities(
+                            inputs[0], inputs[1], inputs[2], inputs[3], inputs[4], inputs[5], type);
+                        expect_close("price", s.price, black_scholes_price<double>(spot, 100.0, time, 0.03, 0.01, vol, type), 1e-12);
+                        expect_close("delta", s.delta, central_difference(inputs, 0, type), 1e-6);
+                        expect_close("strike_delta", s.strike_delta, central_difference(inputs, 1, type), 1e-6);
+                        expect_close("theta", s.theta, central_difference(inputs, 2, type), 1e-6);
+                        expect_close("rho", s.rho, central_difference(inputs, 3, type), 1e-6);
+                        expect_close("dividend_rho", s.dividend_rho, central_difference(inputs, 4, type), 1e-6);
+                        expect_close("vega", s.vega, central_difference(inputs, 5, type), 1e-6);
+                        ++cases;
+                    }
+                }
+            }
+        }
+        std::cout << "Finite-difference check: " << cases << " cases" << std::endl;
+    }
+
+    // The closed-form overload must agree with the tape for flat rates, where the
+    // zero rates r(T), q(T) are the inputs and theta holds them fixed either way.
+    void check_closed_form() {
+        int cases = 0;
+        for (OptionType type : {OptionType::Call, OptionType::Put}) {
+            for (double spot : {80.0, 100.0, 125.0}) {
+                for (double time : {0.05, 0.5, 2.0}) {
+                    for (double vol : {0.1, 0.25, 0.6}) {
+                        const MarketData market(spot, 0.03, 0.01);
+                        BlackScholesSensitivities tape = black_scholes_sensitivities(spot, 100.0, time, 0.03, 0.01, vol, type);
+                        BlackScholesSensitivities closed = black_scholes_sensitivities(
+                            make_expiry_factors(market, time), 100.0, vol, type);
+                        expect_close("closed-form price", closed.price, tape.price, 1e-12);
+                        expect_close("closed-form delta", closed.delta, tape.delta, 1e-12);
+                        expect_close("closed-form vega", closed.vega, tape.vega, 1e-12);
+                        expect_close("closed-form rho", closed.rho, tape.rho, 1e-12);
+                        expect_close("closed-form dividend_rho", closed.dividend_rho, tape.dividend_rho, 1e-12);
+                        expect_close("closed-form theta", closed.theta, tape.theta, 1e-12);
+                        expect_close("closed-form strike_delta", closed.strike_delta, tape.strike_delta, 1e-12);
+                        ++cases;
+                    }
+                }
+            }
+        }
+        std::cout << "Closed-form check: " << cases << " cases" << std::endl;
+    }
+
+    template <typename Operation>
+    void expect_throws(const char* what, Operation&& operation) {
+        try {
+            operation();
+        } catch (const std::logic_error&) {
+            return;
+        }
+        std::cerr << "FAIL: " << what << " did not throw" << std::endl;
+        ++failures;
+    }
+
+    void check_tape_misuse() {
+        adjoint::Tape first;
+        adjoint::Tape second;
+        adjoint::Real x = first.input(2.0);
+        adjoint::Real y = second.input(3.0);
+
+        expect_throws("operation with no tape active", [&] { return x * 2.0; });
+        {
+            adjoint::ActiveTape recording(second);
+            expect_throws("input of another tape", [&] { return x + 1.0; });
+            expect_throws("inputs of two tapes", [&] { return x * y; });
+        }
+        {
+            adjoint::ActiveTape recording(first);
+            adjoint::Real z = x * x;
+            first.rewind();
+            expect_throws("input recorded before a rewind", [&] { return z * 2.0; });
+            expect_throws("propagating an output from before a rewind", [&] { first.propagate(z); });
+        }
+        expect_throws("adjoint of another tape's input", [&] { return second.adjoint(x); });
+
+        adjoint::Real constant = adjoint::Real(1.0) * 2.0; // Constants need no tape
+        expect_close("constant arithmetic without a tape", constant.value(), 2.0, 0.0);
+        std::cout << "Tape misuse check done" << std::endl;
+    }
+
+    void check_caller_tape_kept() {
+        if (adjoint::Tape::active() != nullptr) {
+            std::cerr << "FAIL: a tape is active before any was activated" << std::endl;
+            ++failures;
+        }
+        black_scholes_sensitivities(100.0, 100.0, 1.0, 0.03, 0.01, 0.2, OptionType::Call);
+        if (adjoint::Tape::active() != nullptr) {
+            std::cerr << "FAIL: black_scholes_sensitivities left its tape active" << std::endl;
+            ++failures;
+        }
+
+        adjoint::Tape outer;
+        adjoint::ActiveTape recording(outer);
+        adjoint::Real x = outer.input(2.0);
+        adjoint::Real y = x * x;
+        black_scholes_sensitivities(100.0, 100.0, 1.0, 0.03, 0.01, 0.2, OptionType::Put);
+        if (adjoint::Tape::active() != &outer) {
+            std::cerr << "FAIL: black_scholes_sensitivities did not restore the caller's tape" << std::endl;
+            ++failures;
+        }
+        adjoint::Real z = y * x; // Must still be recorded on the outer tape
+        outer.propagate(z);
+        expect_close("d(x^3)/dx after nested call", outer.adjoint(x), 12.0, 1e-15);
+        std::cout << "Nested tape check done" << std::endl;
+    }
+
+    // Book of options on one underlying, each with its own volatility input.
+    template <typename Number>
+    Number book_value(const std::vector<Number>& vols) {
+        Number total(0.0);
+        for (std::size_t i = 0; i < vols.size(); ++i) {
+            double strike = 80.0 + 40.0 * static_cast<double>(i) / static_cast<double>(std::max<std::size_t>(vols.size(), 1));
+            total += black_scholes_price<Number>(Number(100.0), Number(strike), Number(0.75), Number(0.03),
+                                                 Number(0.01), vols[i], OptionType::Call);
+        }
+        return total;
+    }
+
+    // Central bump-and-reprice: two revaluations of the whole book per input.
+    std::vector<double> bump_gradient(std::vector<double> vols) {
+        std::vector<double> gradient(vols.size());
+        for (std::size_t i = 0; i < vols.size(); ++i) {
+            double original = vols[i];
+            vols[i] = original + 1e-6;
+            double up = book_value(vols);
+            vols[i] = original - 1e-6;
+            double down = book_value(vols);
+            vols[i] = original;
+            gradient[i] = (up - down) / 2e-6;
+        }
+        return gradient;
+    }
+
+    std::vector<double> adjoint_gradient(const std::vector<double>& vols, adjoint::Tape& tape) {
+        tape.rewind();
+        std::vector<adjoint::Real> inputs;
+        inputs.reserve(vols.size());
+        adjoint::Real value;
+        {
+            adjoint::ActiveTape recording(tape);
+            for (double vol : vols) inputs.push_back(tape.input(vol));
+            value = book_value(inputs);
+        }
+        tape.propagate(value);
+
+        std::vector<double> gradient(vols.size());
+        for (std::size_t i = 0; i < vols.size(); ++i) gradient[i] = tape.adjoint(inputs[i]);
+        return gradient;
+    }
+
+    template <typename Function>
+    double microseconds_per_call(int repeats, Function&& function) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeats; ++i) function();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::micro>(end - start).count() / repeats;
+    }
+
+    void benchmark(int repeats) {
+        adjoint::Tape tape;
+        volatile double sink = 0.0; // Keeps the timed calls from being optimized away
+        std::cout << std::fixed << std::setprecision(2);
+        for (std::size_t inputs : {std::size_t{1}, std::size_t{10}, std::size_t{100}}) {
+            std::vector<double> vols(inputs);
+            for (std::size_t i = 0; i < inputs; ++i) vols[i] = 0.15 + 0.002 * static_cast<double>(i);
+
+            std::vector<double> bumped = bump_gradient(vols);
+            std::vector<double> adjoint = adjoint_gradient(vols, tape);
+            for (std::size_t i = 0; i < inputs; ++i) expect_close("book vega", adjoint[i], bumped[i], 1e-6);
+
+            int scaled = std::max(1, repeats / static_cast<int>(inputs));
+            double bump_us = microseconds_per_call(scaled, [&] { sink = sink + bump_gradient(vols)[0]; });
+            double adjoint_us = microseconds_per_call(scaled, [&] { sink = sink + adjoint_gradient(vols, tape)[0]; });
+            std::cout << inputs << " inputs: bump " << bump_us << " us, adjoint " << adjoint_us
+                      << " us, speed-up " << bump_us / adjoint_us << "x" << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int repeats = argc > 1 ? std::atoi(argv[1]) : 2000;
+    if (repeats <= 0) {
+        std::cerr << "Usage: adjoint_test [benchmark_repeats]" << std::endl;
+        return 2;
+    }
+
+    check_finite_differences();
+    check_closed_form();
+    check_tape_misuse();
+    check_caller_tape_kept();
+    benchmark(repeats);
+
+    std::cout << (failures == 0 ? "PASSED" : "FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}